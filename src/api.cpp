@@ -0,0 +1,389 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#include <Arduino.h>
+
+// this file is generated during make
+#include "buildinfo.h"
+
+#include "system.h"
+#include "module.h"
+#include "crash.h"
+#include "net.h"
+
+#include "api.h"
+
+// a field is only evaluated if it was asked for
+#define FIELD(_NAME_, _VALUE_) if (field(PSTR(_NAME_))) value(_VALUE_)
+
+// array elements rendered per step, see api_render()
+#define ITEMS_PER_STEP 4
+
+static const char PROGMEM uri_device[]  = "/api/v1/device";
+static const char PROGMEM uri_system[]  = "/api/v1/system";
+static const char PROGMEM uri_flash[]   = "/api/v1/flash";
+static const char PROGMEM uri_net[]     = "/api/v1/net";
+static const char PROGMEM uri_wifi[]    = "/api/v1/wifi";
+static const char PROGMEM uri_modules[] = "/api/v1/modules";
+static const char PROGMEM uri_load[]    = "/api/v1/load";
+static const char PROGMEM uri_crash[]   = "/api/v1/crash";
+
+static PGM_P const endpoints[] PROGMEM = {
+  uri_device,
+  uri_system,
+  uri_flash,
+  uri_net,
+  uri_wifi,
+  uri_modules,
+  uri_load,
+  uri_crash
+};
+
+#define ENDPOINT_COUNT (sizeof (endpoints) / sizeof (PGM_P))
+
+// state of the object being rendered, only valid within api_render()
+static Print *out = NULL;
+static const char *fields = NULL;
+static bool first = true;
+
+static bool selected(PGM_P name) {
+  const char *f = fields;
+  int len = strlen_P(name);
+
+  if (*f == '\0') return (true);
+
+  while (*f) {
+    if (!strncmp_P(f, name, len) && ((f[len] == ',') || (f[len] == '\0'))) {
+      return (true);
+    }
+
+    f = strchr(f, ',');
+    if (!f) break;
+    f++;
+  }
+
+  return (false);
+}
+
+static bool field(PGM_P name) {
+  if (!selected(name)) return (false);
+
+  out->print((first) ? '{' : ',');
+  out->print('"');
+  out->print(FPSTR(name));
+  out->print(F("\":"));
+
+  first = false;
+
+  return (true);
+}
+
+static void value(int           v) { out->print(v); }
+static void value(long          v) { out->print(v); }
+static void value(unsigned int  v) { out->print(v); }
+static void value(unsigned long v) { out->print(v); }
+static void value(uint8_t       v) { out->print(v); }
+static void value(bool          v) { out->print((v) ? F("true") : F("false")); }
+
+static void value(const char *v) {
+  out->print('"');
+
+  for (; *v; v++) {
+    char c = *v;
+
+    if ((c == '"') || (c == '\\')) {
+      out->print('\\');
+      out->print(c);
+    } else if ((uint8_t)c < 0x20) {
+      out->printf("\\u%04x", c);
+    } else {
+      out->print(c);
+    }
+  }
+
+  out->print('"');
+}
+
+static void value(const String &v) {
+  value(v.c_str());
+}
+
+// addresses as strings, crash.pl and addr2line want them in hex
+static void hex(uint32_t v) {
+  out->printf("\"0x%08x\"", v);
+}
+
+static void object_begin(void) {
+  first = true;
+}
+
+static void object_end(void) {
+  // an empty selection still yields a valid object
+  out->print((first) ? F("{}") : F("}"));
+}
+
+static void render_device(void) {
+  object_begin();
+
+  FIELD("hw_device",   system_hw_device());
+  FIELD("hw_version",  system_hw_version());
+  FIELD("id",          device_id);
+  FIELD("name",        device_name);
+  FIELD("fw_version",  system_fw_version());
+  FIELD("fw_build",    system_fw_build());
+  FIELD("boot",        ESP.getBootVersion());
+  FIELD("source",      _BuildInfo.src_version);
+  FIELD("core",        _BuildInfo.env_version);
+  FIELD("sdk",         ESP.getSdkVersion());
+  FIELD("build_date",  _BuildInfo.date);
+  FIELD("build_time",  _BuildInfo.time);
+
+  object_end();
+}
+
+static void render_system(void) {
+  object_begin();
+
+  FIELD("uptime",      millis() / 1000);
+  FIELD("utc",         system_utc());
+  FIELD("reset",       ESP.getResetReason());
+  FIELD("sketch",      system_sketch_size());
+  FIELD("sketch_free", system_free_sketch_space());
+  FIELD("heap",        system_free_heap());
+  FIELD("stack",       system_free_stack());
+  FIELD("stack_ok",    !system_stack_corrupt());
+  FIELD("cpu_mhz",     ESP.getCpuFreqMHz());
+  FIELD("cpu_load",    system_cpu_load());
+  FIELD("mem_usage",   system_mem_usage());
+  FIELD("net_traffic", system_net_traffic());
+  FIELD("loops",       system_main_loops());
+
+  object_end();
+}
+
+static void render_flash(void) {
+  int mode = ESP.getFlashChipMode();
+  const char *mode_str = "UNKNOWN";
+
+       if (mode == FM_QIO)  mode_str = "QIO";
+  else if (mode == FM_QOUT) mode_str = "QOUT";
+  else if (mode == FM_DIO)  mode_str = "DIO";
+  else if (mode == FM_DOUT) mode_str = "DOUT";
+
+  object_begin();
+
+  FIELD("chip_id",     ESP.getFlashChipId());
+  FIELD("real_size",   ESP.getFlashChipRealSize());
+  FIELD("size",        ESP.getFlashChipSize());
+  FIELD("speed",       ESP.getFlashChipSpeed());
+  FIELD("mode",        mode_str);
+
+  object_end();
+}
+
+static void render_net(void) {
+  object_begin();
+
+  FIELD("hostname",    net_hostname());
+  FIELD("ssid",        net_ssid());
+  FIELD("rssi",        net_rssi() - 100); // dBm, net_rssi() is 0..100
+  FIELD("ip",          net_ip());
+  FIELD("gateway",     net_gateway());
+  FIELD("netmask",     net_netmask());
+  FIELD("dns",         net_dns());
+  FIELD("mac",         net_mac());
+  FIELD("ap_ip",       net_ap_ip());
+  FIELD("ap_gateway",  net_ap_gateway());
+  FIELD("ap_netmask",  net_ap_netmask());
+  FIELD("ap_mac",      net_ap_mac());
+  FIELD("ap_clients",  net_ap_clients());
+
+  object_end();
+}
+
+// returns true if elements are left for the next step
+static bool render_array(int step, int count, void (*item)(int i)) {
+  int i = step * ITEMS_PER_STEP;
+
+  if (step == 0) out->print('[');
+
+  for (int n=0; (n<ITEMS_PER_STEP) && (i<count); n++, i++) {
+    if (i > 0) out->print(',');
+
+    item(i);
+  }
+
+  if (i < count) return (true);
+
+  out->print(']');
+
+  return (false);
+}
+
+// the scan result is cached by net.cpp, GET /scan refreshes it
+static void render_wifi(int i) {
+  const WiFiNetwork &net = net_wifi_network(i);
+  const uint8_t *b = net.bssid;
+  char bssid[18];
+
+  snprintf_P(bssid, sizeof (bssid), PSTR("%02x:%02x:%02x:%02x:%02x:%02x"),
+    b[0], b[1], b[2], b[3], b[4], b[5]
+  );
+
+  object_begin();
+
+  FIELD("ssid",    net.ssid);
+  FIELD("rssi",    net.rssi);    // dBm, like /api/v1/net
+  FIELD("crypt",   net.auth);
+  FIELD("channel", net.channel);
+  FIELD("bssid",   bssid);
+
+  object_end();
+}
+
+static void render_module(int i) {
+  int state;
+
+  module_call_state(i, state);
+
+  object_begin();
+
+  FIELD("name",      module_name(i));
+  FIELD("state",     module_state_str(state));
+
+  object_end();
+}
+
+static void load_array(PGM_P name, int which) {
+  uint16_t entries = system_load_history_entries();
+
+  if (!field(name)) return;
+
+  out->print('[');
+
+  for (uint16_t i=0; i<entries; i++) {
+    SysLoad &load = system_load_history(i);
+
+    if (i > 0) out->print(',');
+
+         if (which == 0) out->print(load.cpu);
+    else if (which == 1) out->print(load.mem);
+    else                 out->print(load.net);
+  }
+
+  out->print(']');
+}
+
+static void render_load(void) {
+  object_begin();
+
+  // oldest entry first, empty unless built as ALPHA
+  load_array(PSTR("cpu"), 0);
+  load_array(PSTR("mem"), 1);
+  load_array(PSTR("net"), 2);
+
+  object_end();
+}
+
+static void render_crash(void) {
+  const CrashReport *r = crash_report();
+
+  object_begin();
+
+  // an empty object if the last reset was a clean one
+  if (r) {
+    FIELD("reason",   crash_reason(r->reason));
+    FIELD("exccause", r->exccause);
+    if (field(PSTR("epc1")))     hex(r->epc1);
+    if (field(PSTR("excvaddr"))) hex(r->excvaddr);
+    if (field(PSTR("depc")))     hex(r->depc);
+    if (field(PSTR("sp")))       hex(r->sp);
+    FIELD("uptime",   r->uptime / 1000);
+    FIELD("module",   r->module);
+
+    if (field(PSTR("stack"))) {
+      out->print('[');
+
+      for (int i=0; i<r->depth; i++) {
+        if (i > 0) out->print(',');
+
+        hex(r->stack[i]);
+      }
+
+      out->print(']');
+    }
+
+    if (field(PSTR("log"))) {
+      out->print('[');
+
+      for (int i=0; i<r->lines; i++) {
+        if (i > 0) out->print(',');
+
+        value(r->log[i]);
+      }
+
+      out->print(']');
+    }
+  }
+
+  object_end();
+}
+
+int api_count(void) {
+  return (ENDPOINT_COUNT);
+}
+
+PGM_P api_uri(int endpoint) {
+  PGM_P uri;
+
+  if ((endpoint < 0) || (endpoint >= ENDPOINT_COUNT)) return (NULL);
+
+  memcpy_P(&uri, &endpoints[endpoint], sizeof (uri));
+
+  return (uri);
+}
+
+bool api_render(Print &print, const String &uri, const String &select, int step) {
+  const char *u = uri.c_str();
+  bool more = false;
+
+  out = &print;
+  fields = select.c_str();
+
+       if (!strcmp_P(u, uri_device))  render_device();
+  else if (!strcmp_P(u, uri_system))  render_system();
+  else if (!strcmp_P(u, uri_flash))   render_flash();
+  else if (!strcmp_P(u, uri_net))     render_net();
+  else if (!strcmp_P(u, uri_wifi))    more = render_array(step, net_wifi_count(), render_wifi);
+  else if (!strcmp_P(u, uri_modules)) more = render_array(step, module_count(), render_module);
+  else if (!strcmp_P(u, uri_load))    render_load();
+  else if (!strcmp_P(u, uri_crash))   render_crash();
+  else {
+    out = NULL;
+
+    return (false);
+  }
+
+  if (!more) out->print('\n');
+
+  out = NULL;
+  fields = NULL;
+
+  return (more);
+}
@@ -17,21 +17,19 @@
     Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
 */
 
-#ifndef _ICON_H_
-#define _ICON_H_
+#ifndef _API_H_
+#define _API_H_
 
-extern const char *fav_png;
-extern int fav_len;
+#include <Arduino.h>
 
-extern const char *save_png;
-extern int save_len;
+// JSON REST API, GET /api/v1/<endpoint>?fields=a,b,c
 
-extern const char *view_png;
-extern int view_len;
+int api_count(void);
 
-extern const char *del_png;
-extern int del_len;
+PGM_P api_uri(int endpoint);
 
-bool icon_init(void);
+// objects are rendered in one step, arrays a few elements per step.
+// returns true if there is more to render in the next step
+bool api_render(Print &out, const String &uri, const String &fields, int step = 0);
 
-#endif // _ICON_H_
+#endif // _API_H_
@@ -0,0 +1,391 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#include "assets.h"
+
+// generated by assets.pl from the files in www/
+#include <webassets.h>
+
+// back references of the gzipped assets reach this far at most, it
+// must match -WindowBits in assets.pl
+#define ASSET_WINDOW  1024
+#define ASSET_MAXBITS 15
+#define ASSET_HEADER  10 // gzip header without name, comment or extra
+#define ASSET_TRAILER 8  // CRC-32 and size
+
+// a DEFLATE decoder along the lines of Mark Adler's puff.c, it decodes
+// one code bit at a time, slow but small
+struct Inflate {
+  const uint8_t *in;
+  uint32_t in_len;
+  uint32_t in_pos;
+  uint32_t bitbuf;
+  uint8_t  bitcnt;
+
+  Print *out;
+  uint32_t out_pos;      // bytes inflated so far
+  uint32_t skip;         // bytes inflated before the first one printed
+  uint32_t end;          // no more bytes are needed from here on
+  uint8_t window[ASSET_WINDOW];
+
+  uint16_t lencnt[ASSET_MAXBITS + 1];
+  uint16_t lensym[288];
+  uint16_t distcnt[ASSET_MAXBITS + 1];
+  uint16_t distsym[30];
+
+  bool error;
+};
+
+static const uint16_t PROGMEM len_base[] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const uint8_t PROGMEM len_extra[] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const uint16_t PROGMEM dist_base[] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577
+};
+
+static const uint8_t PROGMEM dist_extra[] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// order of the code length code lengths in a dynamic block header
+static const uint8_t PROGMEM cl_order[] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+static uint32_t bits(Inflate &s, int need) {
+  uint32_t val = s.bitbuf;
+
+  while (s.bitcnt < need) {
+    if (s.in_pos >= s.in_len) {
+      s.error = true;
+
+      return (0);
+    }
+
+    val |= (uint32_t)pgm_read_byte(s.in + s.in_pos++) << s.bitcnt;
+    s.bitcnt += 8;
+  }
+
+  s.bitbuf = val >> need;
+  s.bitcnt -= need;
+
+  return (val & ((1UL << need) - 1));
+}
+
+static void emit(Inflate &s, uint8_t c) {
+  s.window[s.out_pos % ASSET_WINDOW] = c;
+
+  if ((s.out_pos >= s.skip) && (s.out_pos < s.end)) s.out->write(c);
+
+  s.out_pos++;
+}
+
+// canonical code from the code lengths, returns 0 if the code is
+// complete, >0 if it is incomplete and <0 if it is over-subscribed
+static int build(uint16_t *count, uint16_t *symbol, const uint8_t *length, int n) {
+  uint16_t offs[ASSET_MAXBITS + 1];
+  int left = 1;
+
+  memset(count, 0, (ASSET_MAXBITS + 1) * sizeof (uint16_t));
+
+  for (int i=0; i<n; i++) count[length[i]]++;
+
+  if (count[0] == n) return (0);
+
+  for (int len=1; len<=ASSET_MAXBITS; len++) {
+    left <<= 1;
+    left -= count[len];
+
+    if (left < 0) return (left);
+  }
+
+  offs[1] = 0;
+
+  for (int len=1; len<ASSET_MAXBITS; len++) {
+    offs[len + 1] = offs[len] + count[len];
+  }
+
+  for (int i=0; i<n; i++) {
+    if (length[i]) symbol[offs[length[i]]++] = i;
+  }
+
+  return (left);
+}
+
+static int decode(Inflate &s, const uint16_t *count, const uint16_t *symbol) {
+  int code = 0, first = 0, index = 0;
+
+  for (int len=1; len<=ASSET_MAXBITS; len++) {
+    code |= bits(s, 1);
+
+    if (s.error) return (-1);
+
+    if (code < (first + count[len])) return (symbol[index + (code - first)]);
+
+    index += count[len];
+    first += count[len];
+    first <<= 1;
+    code <<= 1;
+  }
+
+  s.error = true;
+
+  return (-1);
+}
+
+static void stored(Inflate &s) {
+  uint16_t len, nlen;
+
+  // the rest of the current byte is padding
+  s.bitbuf = 0;
+  s.bitcnt = 0;
+
+  len  = bits(s, 16);
+  nlen = bits(s, 16);
+
+  if (s.error || (len != (uint16_t)~nlen)) {
+    s.error = true;
+
+    return;
+  }
+
+  while (len-- && (s.out_pos < s.end)) {
+    if (s.in_pos >= s.in_len) {
+      s.error = true;
+
+      return;
+    }
+
+    emit(s, pgm_read_byte(s.in + s.in_pos++));
+  }
+}
+
+static void codes(Inflate &s) {
+  int sym;
+
+  while (s.out_pos < s.end) {
+    sym = decode(s, s.lencnt, s.lensym);
+
+    if (sym < 0) return;
+
+    if (sym < 256) {
+      emit(s, sym);
+    } else if (sym == 256) {
+      return;
+    } else {
+      uint32_t len, dist;
+
+      sym -= 257;
+
+      if (sym >= 29) break;
+
+      len = pgm_read_word(&len_base[sym]) + bits(s, pgm_read_byte(&len_extra[sym]));
+
+      sym = decode(s, s.distcnt, s.distsym);
+
+      if ((sym < 0) || (sym >= 30)) break;
+
+      dist = pgm_read_word(&dist_base[sym]) + bits(s, pgm_read_byte(&dist_extra[sym]));
+
+      if (s.error || (dist > s.out_pos) || (dist > ASSET_WINDOW)) break;
+
+      while (len--) emit(s, s.window[(s.out_pos - dist) % ASSET_WINDOW]);
+    }
+  }
+
+  if (s.out_pos < s.end) s.error = true;
+}
+
+static void fixed(Inflate &s) {
+  uint8_t length[288];
+  int i;
+
+  for (i=0;   i<144; i++) length[i] = 8;
+  for (;      i<256; i++) length[i] = 9;
+  for (;      i<280; i++) length[i] = 7;
+  for (;      i<288; i++) length[i] = 8;
+
+  build(s.lencnt, s.lensym, length, 288);
+
+  for (i=0; i<30; i++) length[i] = 5;
+
+  build(s.distcnt, s.distsym, length, 30);
+
+  codes(s);
+}
+
+static void dynamic(Inflate &s) {
+  uint8_t length[286 + 30];
+  int nlen, ndist, ncode, index, err;
+
+  nlen  = bits(s, 5) + 257;
+  ndist = bits(s, 5) + 1;
+  ncode = bits(s, 4) + 4;
+
+  if (s.error || (nlen > 286) || (ndist > 30)) {
+    s.error = true;
+
+    return;
+  }
+
+  memset(length, 0, 19);
+
+  for (index=0; index<ncode; index++) {
+    length[pgm_read_byte(&cl_order[index])] = bits(s, 3);
+  }
+
+  // the code length code goes to the literal/length table for a while
+  if (build(s.lencnt, s.lensym, length, 19) != 0) {
+    s.error = true;
+
+    return;
+  }
+
+  index = 0;
+
+  while (index < (nlen + ndist)) {
+    int sym = decode(s, s.lencnt, s.lensym);
+    uint8_t len = 0;
+
+    if (sym < 0) return;
+
+    if (sym < 16) {
+      length[index++] = sym;
+
+      continue;
+    }
+
+    if (sym == 16) {
+      if (index == 0) break;
+
+      len = length[index - 1];
+      sym = 3 + bits(s, 2);
+    } else if (sym == 17) {
+      sym = 3 + bits(s, 3);
+    } else {
+      sym = 11 + bits(s, 7);
+    }
+
+    if ((index + sym) > (nlen + ndist)) break;
+
+    while (sym--) length[index++] = len;
+  }
+
+  // an incomplete code is fine if it has a single symbol only
+  if ((index < (nlen + ndist)) || (length[256] == 0)) {
+    s.error = true;
+  } else {
+    err = build(s.lencnt, s.lensym, length, nlen);
+
+    if ((err < 0) || ((err > 0) && ((nlen - s.lencnt[0]) != 1))) s.error = true;
+
+    err = build(s.distcnt, s.distsym, length + nlen, ndist);
+
+    if ((err < 0) || ((err > 0) && ((ndist - s.distcnt[0]) != 1))) s.error = true;
+  }
+
+  if (!s.error) codes(s);
+}
+
+int assets_count(void) {
+  return (ASSET_COUNT);
+}
+
+bool asset_get(int i, Asset &asset) {
+  if ((i < 0) || (i >= ASSET_COUNT)) return (false);
+
+  memcpy_P(&asset, &asset_table[i], sizeof (Asset));
+
+  return (true);
+}
+
+bool asset_find(const String &uri, Asset &asset) {
+  for (int i=0; i<ASSET_COUNT; i++) {
+    asset_get(i, asset);
+
+    if (!strcmp_P(uri.c_str(), asset.uri)) return (true);
+  }
+
+  return (false);
+}
+
+// the data is inflated from the start each time, the window only holds
+// what back references need and nothing is kept between two calls
+int asset_inflate(const Asset &asset, Print &out, uint32_t offset, size_t len) {
+  Inflate *s;
+  uint32_t last, type;
+  int ret;
+
+  if (!asset.gzip || (asset.length < (ASSET_HEADER + ASSET_TRAILER))) return (-1);
+
+  if ((pgm_read_byte(asset.data + 0) != 0x1f) ||
+      (pgm_read_byte(asset.data + 1) != 0x8b) ||
+      (pgm_read_byte(asset.data + 2) != 8) ||
+      (pgm_read_byte(asset.data + 3) != 0)) return (-1);
+
+  s = (Inflate *)malloc(sizeof (Inflate));
+  if (!s) return (-1);
+
+  memset(s, 0, sizeof (Inflate));
+
+  s->in     = asset.data + ASSET_HEADER;
+  s->in_len = asset.length - ASSET_HEADER - ASSET_TRAILER;
+  s->out    = &out;
+  s->skip   = offset;
+  s->end    = offset + len;
+
+  do {
+    last = bits(*s, 1);
+    type = bits(*s, 2);
+
+    if (s->error) break;
+
+    if (type == 0) {
+      stored(*s);
+    } else if (type == 1) {
+      fixed(*s);
+    } else if (type == 2) {
+      dynamic(*s);
+    } else {
+      s->error = true;
+    }
+  } while (!last && !s->error && (s->out_pos < s->end));
+
+  if (s->error) {
+    ret = -1;
+  } else if (s->out_pos <= offset) {
+    ret = 0;
+  } else {
+    ret = min(s->out_pos, s->end) - offset;
+  }
+
+  free(s);
+
+  return (ret);
+}
@@ -0,0 +1,50 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#ifndef _ASSETS_H_
+#define _ASSETS_H_
+
+#include <Arduino.h>
+
+// static files of the web UI, generated at build time from src/www
+struct Asset {
+  PGM_P uri;
+  PGM_P type;
+  PGM_P etag;
+
+  const uint8_t *data;
+  uint32_t length;
+
+  bool gzip;           // data is gzip compressed
+
+  // the inflated data, for clients that don't accept gzip
+  PGM_P raw_etag;
+  uint32_t raw_length;
+};
+
+int assets_count(void);
+
+bool asset_get(int i, Asset &asset);
+bool asset_find(const String &uri, Asset &asset);
+
+// prints len bytes of the inflated data from offset on, returns the
+// number of bytes printed or -1 if the data is broken
+int asset_inflate(const Asset &asset, Print &out, uint32_t offset, size_t len);
+
+#endif // _ASSETS_H_
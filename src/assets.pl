@@ -0,0 +1,162 @@
+#!/usr/bin/perl
+#
+# This file is part of Genesys.
+#
+# Genesys is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Genesys is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+#
+# Converts the static files of the web UI into PROGMEM arrays.
+#
+# usage: assets.pl <version> <file> ... > webassets.h
+#
+# CSS and JavaScript are minified, then every file is gzipped and the
+# compressed copy is kept if it is smaller than the original. Only one
+# copy is stored, clients that don't accept gzip get it inflated on the
+# fly. DEFLATE back references are limited to a window of 1KB for that
+# (ASSET_WINDOW in assets.cpp). The ETag of both representations is
+# derived from the firmware version and a hash of their bytes.
+
+use strict;
+use warnings;
+
+use File::Basename;
+use Digest::MD5 qw(md5_hex);
+use Compress::Raw::Zlib;
+
+my %types = (
+  css  => 'text/css',
+  js   => 'text/javascript',
+  html => 'text/html',
+  png  => 'image/png',
+  ico  => 'image/x-icon',
+  svg  => 'image/svg+xml',
+);
+
+my $version = shift @ARGV or die "usage: $0 <version> <file> ...\n";
+
+sub minify {
+  my ($data, $ext) = @_;
+
+  # block comments (never used inside strings in our sources)
+  $data =~ s{/\*.*?\*/}{}gs if ($ext eq 'css');
+
+  my @lines;
+
+  foreach my $line (split /\n/, $data) {
+    $line =~ s/^\s+//;
+    $line =~ s/\s+$//;
+
+    next if ($line eq '');
+    next if (($ext eq 'js') && ($line =~ m{^//}));
+
+    push @lines, $line;
+  }
+
+  # keep the newlines, JavaScript relies on automatic semicolon insertion
+  return join("\n", @lines) . "\n";
+}
+
+# gzip with a small window, so the device can inflate it with little RAM
+sub gzip_window {
+  my ($data) = @_;
+  my ($z, $status) = Compress::Raw::Zlib::Deflate->new(
+    -Level => 9, -MemLevel => 9, -WindowBits => -10, -AppendOutput => 1
+  );
+  my $out = '';
+
+  die "deflate: $status\n" if ($status != Z_OK);
+
+  $z->deflate($data, $out) == Z_OK or die "deflate failed\n";
+  $z->flush($out) == Z_OK or die "deflate failed\n";
+
+  # minimal header (no name, no mtime), trailer with CRC-32 and size
+  return pack('C10', 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 2, 3) . $out .
+         pack('VV', crc32($data), length($data));
+}
+
+sub c_array {
+  my ($data) = @_;
+  my @bytes = map { sprintf('0x%02x', $_) } unpack('C*', $data);
+  my $str = '';
+
+  while (my @row = splice(@bytes, 0, 12)) {
+    $str .= '  ' . join(', ', @row) . ",\n";
+  }
+
+  return $str;
+}
+
+print "// generated by assets.pl, do not edit\n\n";
+
+my @table;
+my ($total_raw, $total_out) = (0, 0);
+
+foreach my $file (sort @ARGV) {
+  my ($name, $dir, $ext) = fileparse($file, qr/\.[^.]*/);
+  my $id = "asset_$name" . '_' . substr($ext, 1);
+
+  $ext = substr($ext, 1);
+
+  my $type = $types{$ext} or die "$file: unknown content type\n";
+
+  open(my $fh, '<:raw', $file) or die "$file: $!\n";
+  my $data = do { local $/; <$fh> };
+  close($fh);
+
+  $total_raw += length($data);
+
+  $data = minify($data, $ext) if (($ext eq 'css') || ($ext eq 'js'));
+
+  my $gz = gzip_window($data);
+
+  my $compressed = (length($gz) < length($data)) ? 1 : 0;
+  my $raw = $data;
+
+  $data = $gz if ($compressed);
+
+  $total_out += length($data);
+
+  my $etag = sprintf('\"%s-%s\"', $version, substr(md5_hex($data), 0, 8));
+  my $raw_etag = sprintf('\"%s-%s\"', $version, substr(md5_hex($raw), 0, 8));
+
+  print "static const char ${id}_uri[]  PROGMEM = \"/$name.$ext\";\n";
+  print "static const char ${id}_type[] PROGMEM = \"$type\";\n";
+  print "static const char ${id}_etag[] PROGMEM = \"$etag\";\n\n";
+  print "static const uint8_t ${id}_data[] PROGMEM = {\n";
+  print c_array($data);
+  print "};\n\n";
+
+  if ($compressed) {
+    print "static const char ${id}_raw_etag[] PROGMEM = \"$raw_etag\";\n\n";
+
+    push @table, sprintf(
+      "  { %s_uri, %s_type, %s_etag, %s_data, %d, true,  %s_raw_etag, %d },\n",
+      $id, $id, $id, $id, length($data), $id, length($raw)
+    );
+  } else {
+    push @table, sprintf(
+      "  { %s_uri, %s_type, %s_etag, %s_data, %d, false, NULL, 0 },\n",
+      $id, $id, $id, $id, length($data)
+    );
+  }
+}
+
+print "static const Asset asset_table[] PROGMEM = {\n";
+print @table;
+print "};\n\n";
+
+print "#define ASSET_COUNT " . scalar(@table) . "\n";
+
+printf STDERR "  Assets: %d bytes -> %d bytes\n", $total_raw, $total_out;
@@ -0,0 +1,173 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#include <Arduino.h>
+
+#include "cache.h"
+
+struct CacheEntry {
+  String key;
+  uint8_t tags;
+  uint32_t stored;     // millis()
+  uint32_t ttl;        // ms
+
+  uint8_t *data;
+  size_t length;
+};
+
+static CacheEntry cache[CACHE_ENTRIES];
+
+static void entry_free(CacheEntry &e) {
+  free(e.data);
+
+  e.key    = String();
+  e.data   = NULL;
+  e.length = 0;
+}
+
+static bool entry_expired(const CacheEntry &e) {
+  return (millis() - e.stored > e.ttl);
+}
+
+static void store(const String &key, uint8_t *data, size_t length,
+                  uint32_t ttl, uint8_t tags) {
+  CacheEntry *e = &cache[0];
+
+  // replace the same key, a free slot or else the oldest entry
+  for (int i=0; i<CACHE_ENTRIES; i++) {
+    if (cache[i].data && (cache[i].key == key)) {
+      e = &cache[i];
+      break;
+    }
+
+    if (!cache[i].data) {
+      e = &cache[i];
+    } else if (e->data && ((int32_t)(cache[i].stored - e->stored) < 0)) {
+      e = &cache[i];
+    }
+  }
+
+  entry_free(*e);
+
+  e->key    = key;
+  e->tags   = tags;
+  e->stored = millis();
+  e->ttl    = ttl;
+  e->data   = data;
+  e->length = length;
+}
+
+bool cache_send(Print &out, const String &key) {
+  for (int i=0; i<CACHE_ENTRIES; i++) {
+    CacheEntry &e = cache[i];
+
+    if (!e.data || (e.key != key)) continue;
+
+    if (entry_expired(e)) {
+      entry_free(e);
+
+      return (false);
+    }
+
+    out.write(e.data, e.length);
+
+    return (true);
+  }
+
+  return (false);
+}
+
+void cache_invalidate(uint8_t tags) {
+  for (int i=0; i<CACHE_ENTRIES; i++) {
+    if (cache[i].data && (cache[i].tags & tags)) entry_free(cache[i]);
+  }
+}
+
+void cache_poll(void) {
+  // give the heap back as soon as an entry is stale
+  for (int i=0; i<CACHE_ENTRIES; i++) {
+    if (cache[i].data && entry_expired(cache[i])) entry_free(cache[i]);
+  }
+}
+
+void cache_clear(void) {
+  cache_invalidate(CACHE_TAG_ALL);
+}
+
+CacheWriter::CacheWriter(Print &out, const String &key,
+                         uint32_t ttl, uint8_t tags)
+  : out(out), key(key), ttl(ttl), tags(tags) {
+
+  buf      = NULL;
+  len      = 0;
+  size     = 0;
+  overflow = false;
+}
+
+CacheWriter::~CacheWriter(void) {
+  if (overflow || !len) {
+    free(buf);
+  } else {
+    uint8_t *tmp = (uint8_t *)realloc(buf, len);
+
+    // the cache takes over the buffer
+    store(key, (tmp) ? tmp : buf, len, ttl, tags);
+  }
+}
+
+void CacheWriter::discard(void) {
+  free(buf);
+  buf = NULL;
+  overflow = true;
+}
+
+size_t CacheWriter::write(uint8_t c) {
+  return (write(&c, 1));
+}
+
+size_t CacheWriter::write(const uint8_t *data, size_t n) {
+  size_t ret = out.write(data, n);
+
+  if (overflow) return (ret);
+
+  if (len + n > size) {
+    size_t grow = max(size * 2, len + n);
+    uint8_t *tmp = NULL;
+
+    if (grow > CACHE_ENTRY_SIZE) grow = CACHE_ENTRY_SIZE;
+    if (len + n <= grow) tmp = (uint8_t *)realloc(buf, grow);
+
+    if (!tmp) {
+      // too large or out of memory, the response is just not cached
+      free(buf);
+      buf = NULL;
+      overflow = true;
+
+      return (ret);
+    }
+
+    buf = tmp;
+    size = grow;
+  }
+
+  memcpy(buf + len, data, n);
+  len += n;
+
+  return (ret);
+}
@@ -0,0 +1,71 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+#include <Arduino.h>
+
+#define CACHE_ENTRIES       4
+#define CACHE_ENTRY_SIZE 3072 // larger responses are not cached
+
+// what a cached response depends on, see cache_invalidate()
+#define CACHE_TAG_CONFIG (1 << 0)
+#define CACHE_TAG_FILES  (1 << 1)
+#define CACHE_TAG_WIFI   (1 << 2)
+#define CACHE_TAG_ALL    0xff
+
+// writes a cached copy of key to out, false if there is none
+bool cache_send(Print &out, const String &key);
+
+void cache_invalidate(uint8_t tags);
+void cache_poll(void);
+void cache_clear(void);
+
+// passes everything on to out and stores a copy under key when
+// it goes out of scope, unless the response grew too large
+class CacheWriter : public Print {
+
+public:
+
+  CacheWriter(Print &out, const String &key, uint32_t ttl, uint8_t tags);
+  ~CacheWriter(void);
+
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *data, size_t n);
+  using Print::write;
+
+  // keeps passing writes on, but nothing is stored
+  void discard(void);
+
+private:
+
+  Print &out;
+  String key;
+  uint32_t ttl;
+  uint8_t tags;
+
+  uint8_t *buf;
+  size_t len;
+  size_t size;
+  bool overflow;
+
+};
+
+#endif // _CACHE_H_
@@ -47,7 +47,8 @@ enum TaskID {
   TASK_ID_NONE,
   TASK_ID_EDIT,
   TASK_ID_TOP,
-  TASK_ID_C64
+  TASK_ID_C64,
+  TASK_ID_SCAN
 };
 
 class Task {
@@ -356,6 +357,7 @@ static void ps(Terminal &term, const String &arg) {
       if (t->id == TASK_ID_EDIT) cmd = F("edit ");
       if (t->id == TASK_ID_TOP)  cmd = F("top ");
       if (t->id == TASK_ID_C64)  cmd = F("c64 ");
+      if (t->id == TASK_ID_SCAN) cmd = F("scan ");
 
       cmd += t->arg;
 
@@ -651,6 +653,38 @@ static int exec_c64(Task *task) {
   return (task->pid);
 }
 
+static int exec_scan(Task *task) {
+  Terminal &term = task->term;
+
+  if (task->state == TASK_STATE_START) {
+    if (!net_scan_wifi()) {
+      term.Print(F("scan: could not start scan\r\n"));
+
+      task->state = TASK_STATE_STOP;
+    } else {
+      task->state = TASK_STATE_EXEC;
+    }
+  } else if (task->state == TASK_STATE_STOP) {
+    cli_task_delete(task->pid);
+
+    return (-1);
+  } else {
+    // wait for the background scan without blocking the loop
+    if (!net_scan_running()) {
+      String str;
+
+      system_wifi_info(str);
+      term.Print(str);
+
+      task->state = TASK_STATE_STOP;
+    }
+
+    while (term.tty.available()) term.tty.read();
+  }
+
+  return (task->pid);
+}
+
 static int exec_edit(Task *task) {
   if (task->state == TASK_STATE_START) {
     task->data = edit_start(task->term, task->arg);
@@ -739,6 +773,7 @@ int cli_poll_task(int pid) {
     if (t->id == TASK_ID_EDIT) return (exec_edit(t));
     if (t->id == TASK_ID_TOP)  return (exec_top(t));
     if (t->id == TASK_ID_C64)  return (exec_c64(t));
+    if (t->id == TASK_ID_SCAN) return (exec_scan(t));
   }
 }
 
@@ -928,8 +963,7 @@ int cli_run_command(Terminal &term, const String &line) {
   } else if (cmd == F("ping")) {
     net_ping(arg.c_str());
   } else if (cmd == F("scan")) {
-    net_scan_wifi();
-    system_wifi_info(str);
+    return (cli_task_new(term, TASK_ID_SCAN, arg));
   } else if (cmd == F("clear")) {
     term.ScreenClear();
   } else if (cmd == F("reboot")) {
@@ -944,7 +978,7 @@ int cli_run_command(Terminal &term, const String &line) {
     term.Print(F("\tstate [m]    ... query state of module [m]\r\n"));
     term.Print(F("\tturbo [0|1]  ... switch cpu turbo mode on or off\r\n"));
     term.Print(F("\tconf <k|k=v> ... get or set config key <k>\r\n"));
-    term.Print(F("\tsave         ... save config to EEPROM\r\n"));
+    term.Print(F("\tsave         ... save config to flash\r\n"));
     term.Print(F("\tformat       ... create / filesystem\r\n"));
     term.Print(F("\tls           ... list filesystem content\r\n"));
     term.Print(F("\tcat <f>      ... print content of file <f>\r\n"));
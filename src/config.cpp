@@ -17,175 +17,144 @@
     Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
 */
 
-#include <EEPROM.h>
 #include <IPAddress.h>
 
+extern "C" {
+#include <spi_flash.h>
+}
+
+#include "journal.h"
 #include "system.h"
 #include "module.h"
 #include "xxtea.h"
+#include "cache.h"
 #include "log.h"
 
 #include "config.h"
 
-#define CONFIG_EEPROM_SIZE 4096 // SPI_FLASH_SEC_SIZE
+// flash is read in words
+#define CONFIG_SIZE ((sizeof (Config) + 3) & ~3)
 
 #define CONFIG_MAGIC "GENESYS"
 
-#define CONFIG_VERSION 2
+#define CONFIG_VERSION 3
 
 enum { STR, INT8, INT32, BOOL, IP, PASS };
 
-struct Config *config = NULL;
+// every key of the config, in the order config_export() writes them.
+// STR and PASS are bounded by their length, INT8 and INT32 by their value.
+#define CONFIG_KEYS                               \
+  KEY(user_name,          STR,   0,     16)       \
+  KEY(user_pass,          PASS,  0,     32)       \
+  KEY(device_name,        STR,   0,     16)       \
+  KEY(wifi_enabled,       BOOL,  0,      1)       \
+  KEY(wifi_ssid,          STR,   0,     32)       \
+  KEY(wifi_pass,          PASS,  8,     32)       \
+  KEY(wifi_power,         INT8,  0,     21)       \
+  KEY(wifi_watchdog,      INT32, 0,     60)       \
+  KEY(ip_static,          BOOL,  0,      1)       \
+  KEY(ip_addr,            IP,    0,      0)       \
+  KEY(ip_netmask,         IP,    0,      0)       \
+  KEY(ip_gateway,         IP,    0,      0)       \
+  KEY(ip_dns1,            IP,    0,      0)       \
+  KEY(ip_dns2,            IP,    0,      0)       \
+  KEY(ap_enabled,         BOOL,  0,      1)       \
+  KEY(ap_addr,            IP,    0,      0)       \
+  KEY(ntp_enabled,        BOOL,  0,      1)       \
+  KEY(ntp_interval,       INT32, 1,   1440)       \
+  KEY(ntp_server,         STR,   0,     32)       \
+  KEY(telemetry_enabled,  BOOL,  0,      1)       \
+  KEY(telemetry_url,      STR,   0,     64)       \
+  KEY(telemetry_user,     STR,   0,     16)       \
+  KEY(telemetry_pass,     PASS,  0,     32)       \
+  KEY(telemetry_interval, INT32, 1,   3600)       \
+  KEY(update_enabled,     BOOL,  0,      1)       \
+  KEY(update_url,         STR,   0,     64)       \
+  KEY(update_interval,    INT32, 1,    240)       \
+  KEY(storage_enabled,    BOOL,  0,      1)       \
+  KEY(storage_interval,   INT32, 1,     60)       \
+  KEY(storage_mask,       INT32, 0,   2048)       \
+  KEY(sleep_enabled,      BOOL,  0,      1)       \
+  KEY(sleep_interval,     INT32, 10,  4200)       \
+  KEY(sleep_batch,        INT8,  1,     24)       \
+  KEY(logger_enabled,     BOOL,  0,      1)       \
+  KEY(logger_channels,    INT8,  0,      7)       \
+  KEY(logger_host,        IP,    0,      0)       \
+  KEY(logger_port,        INT32, 0,  65535)       \
+  KEY(mdns_enabled,       BOOL,  0,      1)       \
+  KEY(webserver_enabled,  BOOL,  0,      1)       \
+  KEY(websocket_enabled,  BOOL,  0,      1)       \
+  KEY(telnet_enabled,     BOOL,  0,      1)       \
+  KEY(gpio_enabled,       BOOL,  0,      1)       \
+  KEY(rtc_enabled,        BOOL,  0,      1)       \
+  KEY(ade_enabled,        BOOL,  0,      1)       \
+  KEY(cpu_turbo,          BOOL,  0,      1)
+
+struct ConfigKey {
+  PGM_P    name;
+  uint32_t hash;
+  uint16_t offset;
+  uint8_t  size;
+  uint8_t  type;
+  int32_t  min;
+  int32_t  max;
+};
+
+// FNV-1a, evaluated by the compiler for the table
+static constexpr uint32_t hash(const char *s, uint32_t h = 2166136261) {
+  return ((*s) ? hash(s + 1, (h ^ (uint8_t)*s) * 16777619) : h);
+}
 
-static EEPROMClass *eeprom = NULL;
+#define KEY(_NAME_, _TYPE_, _MIN_, _MAX_) \
+  static const char PROGMEM key_ ## _NAME_[] = #_NAME_;
+CONFIG_KEYS
+#undef KEY
 
-static uint8_t ref = 0;
+#define KEY(_NAME_, _TYPE_, _MIN_, _MAX_) \
+  { key_ ## _NAME_, hash(#_NAME_), offsetof(Config, _NAME_), \
+    sizeof (((Config *)0)->_NAME_), _TYPE_, _MIN_, _MAX_ },
+static const ConfigKey keys[] PROGMEM = { CONFIG_KEYS };
+#undef KEY
 
-static bool config_is_uninitialized = false;
-static bool config_has_new_version  = false;
+#define KEY_COUNT (sizeof (keys) / sizeof (ConfigKey))
 
-static void *ptr(const String &name, int &type, int &min, int &max) {
-  if (!config) config_init();
+static_assert(KEY_COUNT <= 64, "dirty has one bit per key");
 
-  if (name == F("user_name"))          {
-    type = STR;            max = 16;   return (&config->user_name);
-  }
-  if (name == F("user_pass"))          {
-    type = PASS;  min = 0; max = 32;   return (&config->user_pass);
-  }
+extern "C" uint32_t _CONFIG_sector1;
 
-  if (name == F("device_name"))        {
-    type = STR;            max = 16;   return (&config->device_name);
-  }
+struct Config *config = NULL;
 
-  if (name == F("wifi_enabled"))       {
-    type = BOOL;                       return (&config->wifi_enabled);
-  }
-  if (name == F("wifi_ssid"))          {
-    type = STR;            max = 32;   return (&config->wifi_ssid);
-  }
-  if (name == F("wifi_pass"))          {
-    type = PASS;  min = 8; max = 32;   return (&config->wifi_pass);
-  }
-  if (name == F("wifi_power"))         {
-    type = INT8;  min = 0; max = 21;   return (&config->wifi_power);
-  }
-  if (name == F("wifi_watchdog"))      {
-    type = INT32; min = 0; max = 60;   return (&config->wifi_watchdog);
-  }
+// keys changed since the last commit, one bit per entry in keys[]
+static uint64_t dirty = 0;
 
-  if (name == F("ip_static"))          {
-    type = BOOL;                       return (&config->ip_static);
-  }
-  if (name == F("ip_addr"))            {
-    type = IP;                         return (&config->ip_addr);
-  }
-  if (name == F("ip_netmask"))         {
-    type = IP;                         return (&config->ip_netmask);
-  }
-  if (name == F("ip_gateway"))         {
-    type = IP;                         return (&config->ip_gateway);
-  }
-  if (name == F("ip_dns1"))            {
-    type = IP;                         return (&config->ip_dns1);
-  }
-  if (name == F("ip_dns2"))            {
-    type = IP;                         return (&config->ip_dns2);
-  }
+// the config stays loaded, this only counts the users
+static int ref = 0;
 
-  if (name == F("ap_enabled"))         {
-    type = BOOL;                       return (&config->ap_enabled);
-  }
-  if (name == F("ap_addr"))            {
-    type = IP;                         return (&config->ap_addr);
-  }
+static bool config_is_uninitialized = false;
+static bool config_was_imported     = false;
 
-  if (name == F("ntp_enabled"))        {
-    type = BOOL;                       return (&config->ntp_enabled);
-  }
-  if (name == F("ntp_interval"))       {
-    type = INT32; min = 1; max = 1440; return (&config->ntp_interval);
-  }
-  if (name == F("ntp_server"))         {
-    type = STR;            max = 32;   return (&config->ntp_server);
-  }
+// a name only costs a string compare if its hash matches,
+// returns the index of the key or -1
+static int lookup(const String &name, ConfigKey &key) {
+  uint32_t h = hash(name.c_str());
 
-  if (name == F("telemetry_enabled"))  {
-    type = BOOL;                       return (&config->telemetry_enabled);
-  }
-  if (name == F("telemetry_url"))      {
-    type = STR;            max = 64;   return (&config->telemetry_url);
-  }
-  if (name == F("telemetry_user"))     {
-    type = STR;            max = 16;   return (&config->telemetry_user);
-  }
-  if (name == F("telemetry_pass"))     {
-    type = PASS;  min = 0; max = 32;   return (&config->telemetry_pass);
-  }
-  if (name == F("telemetry_interval")) {
-    type = INT32; min = 1; max = 3600; return (&config->telemetry_interval);
-  }
+  for (int i=0; i<KEY_COUNT; i++) {
+    if (pgm_read_dword(&keys[i].hash) != h) continue;
 
-  if (name == F("update_enabled"))     {
-    type = BOOL;                       return (&config->update_enabled);
-  }
-  if (name == F("update_url"))         {
-    type = STR;            max = 64;   return (&config->update_url);
-  }
-  if (name == F("update_interval"))    {
-    type = INT32; min = 1; max = 240;  return (&config->update_interval);
-  }
+    memcpy_P(&key, &keys[i], sizeof (ConfigKey));
 
-  if (name == F("storage_enabled"))    {
-    type = BOOL;                       return (&config->storage_enabled);
-  }
-  if (name == F("storage_interval"))   {
-    type = INT32; min = 1; max = 60;   return (&config->storage_interval);
-  }
-  if (name == F("storage_mask"))       {
-    type = INT32; min = 0; max = 2048; return (&config->storage_mask);
+    if (!strcmp_P(name.c_str(), key.name)) return (i);
   }
 
-  if (name == F("logger_enabled"))     {
-    type = BOOL;                       return (&config->logger_enabled);
-  }
-  if (name == F("logger_channels"))    {
-    type = INT8; min = 0; max = 7;     return (&config->logger_channels);
-  }
-  if (name == F("logger_host"))        {
-    type = IP;                         return (&config->logger_host);
-  }
-  if (name == F("logger_port"))        {
-    type = INT32;                      return (&config->logger_port);
-  }
+  return (-1);
+}
 
-  if (name == F("cpu_turbo"))          {
-    type = BOOL;                       return (&config->cpu_turbo);
-  }
+static bool load(void);
 
-  if (name == F("mdns_enabled"))       {
-    type = BOOL;                       return (&config->mdns_enabled);
-  }
-  if (name == F("webserver_enabled"))  {
-    type = BOOL;                       return (&config->webserver_enabled);
-  }
-  if (name == F("websocket_enabled"))  {
-    type = BOOL;                       return (&config->websocket_enabled);
-  }
-  if (name == F("telnet_enabled"))     {
-    type = BOOL;                       return (&config->telnet_enabled);
-  }
-  if (name == F("gpio_enabled"))       {
-    type = BOOL;                       return (&config->gpio_enabled);
-  }
-  if (name == F("rtc_enabled"))        {
-    type = BOOL;                       return (&config->rtc_enabled);
-  }
-  if (name == F("ade_enabled"))        {
-    type = BOOL;                       return (&config->ade_enabled);
-  }
+static void *ptr(const ConfigKey &key) {
+  if (!config) load();
 
-  return (NULL);
+  return ((uint8_t *)config + key.offset);
 }
 
 static void parse_line(const String &line) {
@@ -204,15 +173,6 @@ static void parse_line(const String &line) {
   }
 }
 
-static void append_line(const String &key, String &str) {
-  String val;
-
-  if (config_get(key, val)) {
-    str += key + F("=");
-    str += val + F("\r\n");
-  }
-}
-
 static bool write_str(char *conf, const String &value, int max) {
   if (value.length() > max) return (false);
 
@@ -333,66 +293,101 @@ static bool read_bool(uint8_t *conf, String &value) {
   return (true);
 }
 
-bool config_set(const String &name, const String &value) {
-  int type, min, max;
-  void *p;
-
-  if ((p = ptr(name, type, min, max))) {
-    if (type == STR)   return (write_str(      (char *)p, value,      max));
-    if (type == PASS)  return (write_pass(     (char *)p, value, min, max));
-    if (type == INT8)  return (write_int8(  (uint8_t *)p, value, min, max));
-    if (type == INT32) return (write_int32((uint32_t *)p, value, min, max));
-    if (type == BOOL)  return (write_bool(  (uint8_t *)p, value          ));
-    if (type == IP)    return (write_ip(   (uint32_t *)p, value          ));
-  }
+static bool set_value(const ConfigKey &key, const String &value) {
+  void *p = ptr(key);
+  int min = key.min, max = key.max;
+
+  if (key.type == STR)   return (write_str(      (char *)p, value,      max));
+  if (key.type == PASS)  return (write_pass(     (char *)p, value, min, max));
+  if (key.type == INT8)  return (write_int8(  (uint8_t *)p, value, min, max));
+  if (key.type == INT32) return (write_int32((uint32_t *)p, value, min, max));
+  if (key.type == BOOL)  return (write_bool(  (uint8_t *)p, value          ));
+  if (key.type == IP)    return (write_ip(   (uint32_t *)p, value          ));
 
   return (false);
 }
 
-bool config_get(const String &name, String &value) {
-  int type, min, max;
-  void *p;
-
-  if ((p = ptr(name, type, min, max))) {
-    if (type == STR)   return (read_str(      (char *)p, value));
-    if (type == PASS)  return (read_pass(     (char *)p, value, max));
-    if (type == INT8)  return (read_int8(  (uint8_t *)p, value));
-    if (type == INT32) return (read_int32((uint32_t *)p, value));
-    if (type == BOOL)  return (read_bool(  (uint8_t *)p, value));
-    if (type == IP)    return (read_ip(   (uint32_t *)p, value));
-  }
+static bool get_value(const ConfigKey &key, String &value) {
+  void *p = ptr(key);
+
+  if (key.type == STR)   return (read_str(      (char *)p, value));
+  if (key.type == PASS)  return (read_pass(     (char *)p, value, key.max));
+  if (key.type == INT8)  return (read_int8(  (uint8_t *)p, value));
+  if (key.type == INT32) return (read_int32((uint32_t *)p, value));
+  if (key.type == BOOL)  return (read_bool(  (uint8_t *)p, value));
+  if (key.type == IP)    return (read_ip(   (uint32_t *)p, value));
 
   return (false);
 }
 
-bool config_clr(const String &name) {
-  int type, min, max;
-  void *p;
-
-  if ((p = ptr(name, type, min, max))) {
-    if (type == PASS) {
-      memset(p, 0, max);
-      // FIXME clearing a password crashes here!
-      //xxtea_encrypt((char *)p, max);
-      return (true);
-    } else if (type == STR) {
-      memset(p, 0, max);
-      return (true);
-    } else if ((type == INT32) || (type == IP)) {
-      *(uint32_t *)p = 0;
-      return (true);
-    } else if (type == INT8) {
-      *(uint8_t *)p = 0;
-      return (true);
-    } else if (type == BOOL) {
-      *(bool *)p = false;
-      return (true);
-    }
+static bool clear_value(const ConfigKey &key) {
+  void *p = ptr(key);
+
+  if (key.type == PASS) {
+    memset(p, 0, key.max);
+    // FIXME clearing a password crashes here!
+    //xxtea_encrypt((char *)p, key.max);
+    return (true);
+  } else if (key.type == STR) {
+    memset(p, 0, key.max);
+    return (true);
+  } else if ((key.type == INT32) || (key.type == IP)) {
+    *(uint32_t *)p = 0;
+    return (true);
+  } else if (key.type == INT8) {
+    *(uint8_t *)p = 0;
+    return (true);
+  } else if (key.type == BOOL) {
+    *(bool *)p = false;
+    return (true);
   }
 
   return (false);
 }
 
+// marks the key dirty if its value differs from old
+static void touch(int i, const ConfigKey &key, const uint8_t *old) {
+  if (memcmp(ptr(key), old, key.size)) dirty |= (1ULL << i);
+}
+
+bool config_set(const String &name, const String &value) {
+  uint8_t old[JOURNAL_MAX_LEN];
+  ConfigKey key;
+  bool ret;
+  int i;
+
+  if ((i = lookup(name, key)) < 0) return (false);
+
+  memcpy(old, ptr(key), key.size);
+  ret = set_value(key, value);
+  touch(i, key, old);
+
+  return (ret);
+}
+
+bool config_get(const String &name, String &value) {
+  ConfigKey key;
+
+  if (lookup(name, key) < 0) return (false);
+
+  return (get_value(key, value));
+}
+
+bool config_clr(const String &name) {
+  uint8_t old[JOURNAL_MAX_LEN];
+  ConfigKey key;
+  bool ret;
+  int i;
+
+  if ((i = lookup(name, key)) < 0) return (false);
+
+  memcpy(old, ptr(key), key.size);
+  ret = clear_value(key);
+  touch(i, key, old);
+
+  return (ret);
+}
+
 void config_import(String &str) {
   String line;
 
@@ -402,64 +397,22 @@ void config_import(String &str) {
 }
 
 void config_export(String &str) {
-  append_line(F("user_name"),          str);
-  append_line(F("user_pass"),          str);
-  append_line(F("device_name"),        str);
-  append_line(F("wifi_enabled"),       str);
-  append_line(F("wifi_ssid"),          str);
-  append_line(F("wifi_pass"),          str);
-  append_line(F("wifi_power"),         str);
-  append_line(F("wifi_watchdog"),      str);
-  append_line(F("ip_static"),          str);
-  append_line(F("ip_addr"),            str);
-  append_line(F("ip_netmask"),         str);
-  append_line(F("ip_gateway"),         str);
-  append_line(F("ip_dns1"),            str);
-  append_line(F("ip_dns2"),            str);
-  append_line(F("ap_enabled"),         str);
-  append_line(F("ap_addr"),            str);
-  append_line(F("ntp_enabled"),        str);
-  append_line(F("ntp_interval"),       str);
-  append_line(F("ntp_server"),         str);
-  append_line(F("telemetry_enabled"),  str);
-  append_line(F("telemetry_url"),      str);
-  append_line(F("telemetry_user"),     str);
-  append_line(F("telemetry_pass"),     str);
-  append_line(F("telemetry_interval"), str);
-  append_line(F("update_enabled"),     str);
-  append_line(F("update_url"),         str);
-  append_line(F("update_interval"),    str);
-  append_line(F("storage_enabled"),    str);
-  append_line(F("storage_interval"),   str);
-  append_line(F("storage_mask"),       str);
-  append_line(F("logger_enabled"),     str);
-  append_line(F("logger_channels"),    str);
-  append_line(F("logger_host"),        str);
-  append_line(F("logger_port"),        str);
-  append_line(F("mdns_enabled"),       str);
-  append_line(F("webserver_enabled"),  str);
-  append_line(F("websocket_enabled"),  str);
-  append_line(F("telnet_enabled"),     str);
-  append_line(F("gpio_enabled"),       str);
-  append_line(F("rtc_enabled"),        str);
-  append_line(F("ade_enabled"),        str);
-  append_line(F("cpu_turbo"),          str);
-}
+  ConfigKey key;
+  String val;
 
-void config_reset(void) {
-  bool unload_eeprom = false;
-  uint8_t ct_a, ct_b, ct_c;
-  IPAddress ip;
+  for (int i=0; i<KEY_COUNT; i++) {
+    memcpy_P(&key, &keys[i], sizeof (ConfigKey));
 
-  if (!config) {
-    config_init();
-    unload_eeprom = true;
+    if (get_value(key, val)) {
+      str += FPSTR(key.name);
+      str += F("=");
+      str += val + F("\r\n");
+    }
   }
+}
 
-  // clear EEPROM
-  for (int i=0; i<CONFIG_EEPROM_SIZE; i++) {
-    eeprom->write(i, 0);
-  }
+static void defaults(void) {
+  memset(config, 0, sizeof (Config));
 
   // set magic string and config version number
   write_str(config->magic           , F(CONFIG_MAGIC),           8);
@@ -514,6 +467,11 @@ void config_reset(void) {
   config->storage_mask              = DEFAULT_STORAGE_MASK;
   config->storage_interval          = DEFAULT_STORAGE_INTERVAL;
 
+  // deep sleep duty cycle
+  config->sleep_enabled             = DEFAULT_SLEEP_ENABLED;
+  config->sleep_interval            = DEFAULT_SLEEP_INTERVAL;
+  config->sleep_batch               = DEFAULT_SLEEP_BATCH;
+
   // debug logging
 #ifdef ALPHA
   config->logger_enabled            = DEFAULT_LOGGER_ENABLED;
@@ -532,15 +490,87 @@ void config_reset(void) {
 
   // CPU speed
   config->cpu_turbo                 = DEFAULT_CPU_TURBO;
+}
+
+static void replay(uint32_t hash, const uint8_t *data, uint8_t len) {
+  ConfigKey key;
+
+  for (int i=0; i<KEY_COUNT; i++) {
+    if (pgm_read_dword(&keys[i].hash) != hash) continue;
+
+    memcpy_P(&key, &keys[i], sizeof (ConfigKey));
+
+    // a key that changed its size is left at its default
+    if (len == key.size) memcpy(ptr(key), data, len);
+
+    return;
+  }
+}
+
+static void snapshot(void) {
+  ConfigKey key;
+
+  for (int i=0; i<KEY_COUNT; i++) {
+    memcpy_P(&key, &keys[i], sizeof (ConfigKey));
+
+    journal_append(key.hash, ptr(key), key.size);
+  }
+}
+
+static bool store_snapshot(void) {
+  if (!journal_compact(snapshot)) {
+    log_print(F("CONF: flash write error"));
+
+    return (false);
+  }
+
+  dirty = 0;
+
+  return (true);
+}
+
+// returns the number of keys written, or -1
+static int commit(void) {
+  int changed = 0;
+  ConfigKey key;
+
+  for (int i=0; (i<KEY_COUNT) && dirty; i++) {
+    if (!(dirty & (1ULL << i))) continue;
+
+    memcpy_P(&key, &keys[i], sizeof (ConfigKey));
+
+    if (!journal_append(key.hash, ptr(key), key.size)) {
+      // the sector is full, start over in the next one
+      return (store_snapshot() ? KEY_COUNT : -1);
+    }
+
+    dirty &= ~(1ULL << i);
+    changed++;
+  }
+
+  return (changed);
+}
 
-  // store in flash
-  if (!eeprom->commit()) {
-    log_print(F("CONF: EEPROM write error"));
+// firmware before the journal kept the Config struct in the second sector
+static bool load_legacy(void) {
+  uint32_t addr = (uint32_t)&_CONFIG_sector1 - 0x40200000;
+
+  if (spi_flash_read(addr, (uint32_t *)config, CONFIG_SIZE) != SPI_FLASH_RESULT_OK) {
+    return (false);
   }
 
-  if (unload_eeprom) {
-    config_fini();
+  if (strncmp_P(config->magic, PSTR(CONFIG_MAGIC), sizeof (config->magic))) {
+    return (false);
   }
+
+  return (config->version == CONFIG_VERSION);
+}
+
+void config_reset(void) {
+  load();
+
+  defaults();
+  store_snapshot();
 }
 
 int config_state(void) {
@@ -555,69 +585,94 @@ void config_poll(void) {
   if (!already_polled) {
     already_polled = true;
 
-    if (sizeof (Config) > CONFIG_EEPROM_SIZE) {
-      log_print(F("CONF: EEPROM too small"));
-    }
     if (config_is_uninitialized) {
-      log_print(F("CONF: EEPROM has been formatted"));
+      log_print(F("CONF: config store has been formatted"));
     }
-    if (config_has_new_version) {
-      log_print(F("CONF: firmware has new config version"));
+    if (config_was_imported) {
+      log_print(F("CONF: config imported from EEPROM"));
     }
   }
 }
 
-bool config_init(void) {
-  ref++;
+// the first call reads the journal, the config stays in RAM from then on
+static bool load(void) {
+  if (config) return (true);
 
-  if (ref > 1) return (true);
+  config = (Config *)malloc(CONFIG_SIZE);
 
-  eeprom = new EEPROMClass();
-  eeprom->begin(sizeof (Config));
-  config = (Config *)eeprom->getDataPtr();
+  // keys missing in the journal keep their defaults
+  defaults();
 
-  if (String(F(CONFIG_MAGIC)) != config->magic) {
-    config_is_uninitialized = true;
-    config_reset();
-  } else {
-    if (config->version != CONFIG_VERSION) {
-      config_has_new_version = true;
-      config_reset();
+  if (journal_load(replay) < 0) {
+    if (load_legacy()) {
+      config_was_imported = true;
+    } else {
+      config_is_uninitialized = true;
+      defaults();
     }
+
+    store_snapshot();
   }
 
   return (true);
 }
 
+bool config_init(void) {
+  ref++;
+
+  return (load());
+}
+
 bool config_fini(void) {
   ref--;
 
-  if (ref < 0) return (false);
-  if (ref > 0) return (true);
+  if (ref < 0) {
+    ref = 0;
 
-  eeprom->end();
-  delete (eeprom);
-  eeprom = NULL;
+    return (false);
+  }
+  if (ref > 0) return (true);
 
-  config = NULL;
+  // changes that were not written explicitly, usually there are none
+  if (dirty) commit();
 
   return (true);
 }
 
 void config_write(void) {
-  int len = sizeof (Config);
+  int total, used, changed;
 
-  if (eeprom) {
-    log_print(F("CONF: writing (%i bytes) to EEPROM"), len);
+  cache_invalidate(CACHE_TAG_CONFIG);
 
-    if (len > CONFIG_EEPROM_SIZE) {
-      log_print(F("CONF: EEPROM too small"));
-    }
+  if (config) {
+    changed = commit();
 
-    eeprom->commit();
+    journal_usage(total, used);
+
+    // store_snapshot() complained already if it failed
+    if (changed >= 0) {
+      log_print(F("CONF: %i keys written to flash (%i of %i bytes used)"),
+        changed, used, total
+      );
+    }
   } else {
-    log_print(F("CONF: EEPROM not mounted"));
+    log_print(F("CONF: config not loaded"));
   }
 }
 
+// the OTA image overwrites the first journal sector, move out of it first
+bool config_reserve(bool reserve) {
+  bool ok = true;
+
+  config_init();
+
+  if (reserve && (journal_sector() == 0)) ok = store_snapshot();
+
+  if (ok) journal_reserve(reserve);
+
+  config_fini();
+
+  return (ok);
+}
+
 MODULE(config)
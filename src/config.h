@@ -68,10 +68,15 @@ struct Config {
   uint32_t update_interval;    // poll interval in hours
 
   // local file storage
-  uint8_t  storage_enabled;    // local storage of CVS files enabled
+  uint8_t  storage_enabled;    // local storage of samples enabled
   uint32_t storage_interval;   // poll interval in seconds
   uint32_t storage_mask;       // bitmask of things to store
 
+  // deep sleep duty cycle
+  uint8_t  sleep_enabled;      // wake, sample, publish and sleep again
+  uint32_t sleep_interval;     // time between two samples in seconds
+  uint8_t  sleep_batch;        // samples collected per publish
+
   // debug logs
   uint8_t  logger_enabled;     // start logger
   uint8_t  logger_channels;    // bitmask for different log channels
@@ -104,6 +109,9 @@ void config_poll(void);
 void config_reset(void);
 void config_write(void);
 
+// keep the config out of the flash that an OTA image is staged in
+bool config_reserve(bool reserve);
+
 void config_import(String &str);
 void config_export(String &str);
 
@@ -0,0 +1,232 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#include <StreamString.h>
+
+extern "C" {
+#include <user_interface.h>
+}
+
+#include "telemetry.h"
+#include "logger.h"
+#include "system.h"
+#include "module.h"
+#include "util.h"
+#include "api.h"
+#include "log.h"
+
+#include "crash.h"
+
+// code lives in IRAM or in the flash mapped at 0x40200000
+#define IRAM_START  0x40100000
+#define IRAM_END    0x40108000
+#define IROM_START  0x40201010
+#define IROM_END    0x40300000
+
+struct CRASH_PrivateData {
+  CrashReport report;
+
+  // sent to the MQTT broker already
+  bool published;
+};
+
+static CRASH_PrivateData *p = NULL;
+
+PGM_P crash_module = NULL;
+
+static uint32_t report_crc(const CrashReport &report) {
+  return (crc32_update(0, &report.reason, sizeof (report) - sizeof (report.crc)));
+}
+
+static bool code_address(uint32_t addr) {
+  if ((addr >= IRAM_START) && (addr < IRAM_END)) return (true);
+  if ((addr >= IROM_START) && (addr < IROM_END)) return (true);
+
+  return (false);
+}
+
+static void copy_line(char *dst, const char *src) {
+  int i;
+
+  for (i=0; (i<CRASH_LINE_LEN-1) && src[i] && (src[i] != '\r'); i++) {
+    dst[i] = src[i];
+  }
+
+  dst[i] = '\0';
+}
+
+// called by the postmortem handler of the core, after the exception is
+// printed to the serial port and before the chip resets
+extern "C" void custom_crash_callback(struct rst_info *info, uint32_t stack, uint32_t stack_end) {
+  CrashReport report;
+  const char *line;
+
+  memset(&report, 0, sizeof (report));
+
+  report.reason   = info->reason;
+  report.exccause = info->exccause;
+  report.epc1     = info->epc1;
+  report.excvaddr = info->excvaddr;
+  report.depc     = info->depc;
+  report.sp       = stack;
+  report.uptime   = millis();
+
+  if (crash_module) {
+    strncpy_P(report.module, crash_module, sizeof (report.module) - 1);
+  }
+
+  // the whole stack doesn't fit, but the return addresses on it do
+  for (uint32_t a=stack; (a<stack_end) && (report.depth<CRASH_STACK); a+=4) {
+    uint32_t value = *(uint32_t *)a;
+
+    if (code_address(value)) report.stack[report.depth++] = value;
+  }
+
+  // oldest line first
+  for (int i=CRASH_LINES-1; i>=0; i--) {
+    if ((line = logger_line(i))) copy_line(report.log[report.lines++], line);
+  }
+
+  report.crc = report_crc(report);
+
+  system_rtc_mem_write(RTC_MEM_CRASH, &report, sizeof (report));
+}
+
+static bool crashed(uint32_t reason) {
+  if (reason == REASON_WDT_RST)       return (true);
+  if (reason == REASON_EXCEPTION_RST) return (true);
+  if (reason == REASON_SOFT_WDT_RST)  return (true);
+
+  return (false);
+}
+
+static void log_report(const CrashReport &report) {
+  const char *module = report.module[0] ? report.module : "none";
+
+  log_print(F("CRASH: %s in module %s after %u s"),
+    crash_reason(report.reason).c_str(), module, report.uptime / 1000
+  );
+  log_print(F("CRASH: exccause=%u epc1=0x%08x excvaddr=0x%08x"),
+    report.exccause, report.epc1, report.excvaddr
+  );
+  log_print(F("CRASH: depc=0x%08x sp=0x%08x"), report.depc, report.sp);
+
+  for (int i=0; i<report.depth; i+=4) {
+    String line = F("CRASH: stack");
+
+    for (int n=i; (n<i+4) && (n<report.depth); n++) {
+      line += F(" 0x") + String(report.stack[n], HEX);
+    }
+
+    log_print(F("%s"), line.c_str());
+  }
+
+  for (int i=0; i<report.lines; i++) {
+    log_print(F("CRASH: log %s"), report.log[i]);
+  }
+}
+
+static void publish(const String &topic, const String &fields) {
+  StreamString json;
+
+  api_render(json, F("/api/v1/crash"), fields);
+
+  telemetry_publish(topic, json);
+}
+
+String crash_reason(uint32_t reason) {
+  if (reason == REASON_WDT_RST)       return (F("Hardware Watchdog"));
+  if (reason == REASON_EXCEPTION_RST) return (F("Exception"));
+  if (reason == REASON_SOFT_WDT_RST)  return (F("Software Watchdog"));
+
+  return (F("Unknown"));
+}
+
+const CrashReport *crash_report(void) {
+  if (!p) return (NULL);
+
+  return (&p->report);
+}
+
+int crash_state(void) {
+  if (p) return (MODULE_STATE_ACTIVE);
+
+  return (MODULE_STATE_INACTIVE);
+}
+
+bool crash_init(void) {
+  rst_info *info = ESP.getResetInfoPtr();
+  CrashReport report;
+  bool stored;
+
+  if (p) return (false);
+
+  system_rtc_mem_read(RTC_MEM_CRASH, &report, sizeof (report));
+
+  stored = (report.crc == report_crc(report));
+
+  if (stored) {
+    // report each crash only once
+    report.crc = 0;
+    system_rtc_mem_write(RTC_MEM_CRASH, &report, sizeof (report));
+  } else if (crashed(info->reason)) {
+    // the core had no chance to call us (hardware watchdog)
+    memset(&report, 0, sizeof (report));
+
+    report.reason   = info->reason;
+    report.exccause = info->exccause;
+    report.epc1     = info->epc1;
+    report.excvaddr = info->excvaddr;
+    report.depc     = info->depc;
+  } else {
+    return (false);
+  }
+
+  p = (CRASH_PrivateData *)malloc(sizeof (CRASH_PrivateData));
+  memset(p, 0, sizeof (CRASH_PrivateData));
+
+  memcpy(&p->report, &report, sizeof (CrashReport));
+
+  log_report(p->report);
+
+  return (true);
+}
+
+bool crash_fini(void) {
+  if (!p) return (false);
+
+  free(p);
+  p = NULL;
+
+  return (true);
+}
+
+void crash_poll(void) {
+  if (p && !p->published && telemetry_connected()) {
+    // MQTT_MAX_PACKET_SIZE is too small for all of it in one message
+    publish(F("debug/crash"),
+      F("reason,exccause,epc1,excvaddr,depc,sp,uptime,module,stack")
+    );
+    publish(F("debug/crash/log"), F("log"));
+
+    p->published = true;
+  }
+}
+
+MODULE(crash)
@@ -0,0 +1,62 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#ifndef _CRASH_H_
+#define _CRASH_H_
+
+#include <Arduino.h>
+
+#define CRASH_STACK    24 // code addresses kept from the stack
+#define CRASH_LINES     3 // last log lines kept
+#define CRASH_LINE_LEN 40
+
+// written to RTC memory by the crash handler, read back on the next boot
+struct CrashReport {
+  uint32_t crc;
+  uint32_t reason;       // rst_info of the SDK
+  uint32_t exccause;
+  uint32_t epc1;
+  uint32_t excvaddr;
+  uint32_t depc;
+  uint32_t sp;           // stack pointer at the time of the crash
+  uint32_t uptime;       // ms
+  char     module[12];   // poll function running when it happened
+  uint8_t  depth;        // valid entries in stack[]
+  uint8_t  lines;        // valid entries in log[]
+  uint16_t reserved;
+  uint32_t stack[CRASH_STACK];
+  char     log[CRASH_LINES][CRASH_LINE_LEN];
+};
+
+// remembers which module is polled, costs one store per call
+#define CRASH_POLL(_MOD_) { crash_module = PSTR(#_MOD_); _MOD_ ## _poll(); }
+
+extern PGM_P crash_module;
+
+int crash_state(void);
+bool crash_init(void);
+bool crash_fini(void);
+void crash_poll(void);
+
+// the report of the last crash, NULL if the last reset was a clean one
+const CrashReport *crash_report(void);
+
+String crash_reason(uint32_t reason);
+
+#endif // _CRASH_H_
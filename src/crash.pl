@@ -0,0 +1,56 @@
+#!/usr/bin/perl
+#
+# This file is part of Genesys.
+#
+# Genesys is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Genesys is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+#
+# Symbolizes a crash report of the firmware in the given ELF file.
+#
+# usage: crash.pl <addr2line> <firmware.elf> [report.txt]
+#
+# The report can be the CRASH: lines of the log, the JSON of the MQTT
+# topic <user>/<device>/debug/crash or of GET /api/v1/crash, or the
+# >>>stack>>> dump printed on the serial port. Every code address in it
+# is resolved, in the order of appearance.
+
+use strict;
+use warnings;
+
+my ($addr2line, $elf) = (shift, shift);
+
+die "usage: $0 <addr2line> <firmware.elf> [report.txt]\n" unless $elf;
+
+my (@addr, %seen);
+
+while (my $line = <>) {
+  # IRAM and the flash mapped at 0x40200000
+  while ($line =~ /\b(?:0x)?(40[123][0-9a-f]{5})\b/gi) {
+    my $a = lc($1);
+
+    push(@addr, "0x$a") unless $seen{$a}++;
+  }
+}
+
+die "no code addresses found\n" unless @addr;
+
+open(my $pipe, '-|', $addr2line, '-aipfC', '-e', $elf, @addr)
+  or die "can't run $addr2line: $!\n";
+
+while (my $line = <$pipe>) {
+  print $line unless $line =~ /\?\? \?\?:0/;
+}
+
+close($pipe);
@@ -0,0 +1,313 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+extern "C" {
+#include <user_interface.h>
+}
+
+#include "telemetry.h"
+#include "system.h"
+#include "module.h"
+#include "config.h"
+#include "clock.h"
+#include "util.h"
+#include "gpio.h"
+#include "log.h"
+#include "rtc.h"
+
+#include "duty.h"
+
+// give up on the broker after that long (ms), the samples are kept
+#define DUTY_TIMEOUT 30000
+
+// samples per message, MQTT_MAX_PACKET_SIZE is only 512 bytes
+#define DUTY_CHUNK 8
+
+struct DutySample {
+  uint32_t clock;        // seconds on the duty clock
+  uint16_t adc;
+  int16_t  temp;         // 1/10 degree celsius
+};
+
+// kept in RTC memory, so it survives deep sleep
+struct DutyState {
+  uint32_t crc;
+  uint32_t clock;        // seconds awake and asleep, roughly
+  uint8_t  wakes;        // since the last publish
+  uint8_t  count;        // samples stored
+  uint8_t  maintenance;  // bring up all modules on the next boot
+  uint8_t  reserved;
+  DutySample sample[DUTY_SAMPLES];
+};
+
+struct DUTY_PrivateData {
+  DutyState state;
+
+  bool publishing;
+  uint32_t publish_ms;
+
+  // settings from config
+  uint32_t interval;
+  uint8_t batch;
+};
+
+static DUTY_PrivateData *p = NULL;
+
+static uint32_t state_crc(const DutyState &state) {
+  return (crc32_update(0, &state.clock, sizeof (state) - sizeof (state.crc)));
+}
+
+static bool state_load(DutyState &state) {
+  system_rtc_mem_read(RTC_MEM_DUTY, &state, sizeof (state));
+
+  if ((state.crc == state_crc(state)) && (state.count <= DUTY_SAMPLES)) {
+    return (true);
+  }
+
+  // power on, the RTC memory holds garbage
+  memset(&state, 0, sizeof (state));
+
+  return (false);
+}
+
+static void state_save(DutyState &state) {
+  state.crc = state_crc(state);
+
+  system_rtc_mem_write(RTC_MEM_DUTY, &state, sizeof (state));
+}
+
+static uint32_t duty_clock(void) {
+  return (p->state.clock + millis() / 1000);
+}
+
+static void drop_samples(int n) {
+  p->state.count -= n;
+
+  memmove(&p->state.sample[0], &p->state.sample[n],
+    p->state.count * sizeof (DutySample)
+  );
+}
+
+static void take_sample(void) {
+  DutySample *sample;
+
+  // the broker has been gone for too long, the oldest sample goes
+  if (p->state.count == DUTY_SAMPLES) drop_samples(1);
+
+  sample = &p->state.sample[p->state.count++];
+
+  sample->clock = duty_clock();
+  sample->adc   = analogRead(17);
+  sample->temp  = rtc_temp() * 10;
+
+  if (p->state.wakes < UINT8_MAX) p->state.wakes++;
+}
+
+static String format_samples(int n, uint32_t now, time_t time) {
+  String m;
+
+  if (!m.reserve(512)) {
+    log_print(F("DUTY: failed to allocate memory"));
+  }
+
+  m += F("{ \"version\":1, \"device_id\":\"");
+  m += String(device_id) + F("\", \"values\":[ ");
+
+  for (int i=0; i<n; i++) {
+    const DutySample &sample = p->state.sample[i];
+    uint32_t age = now - sample.clock;
+
+    if (i) m += F(", ");
+
+    m += F("{ \"time\":");
+    m += String((uint32_t)(time - age)) + F(", \"age\":");
+    m += String(age)                    + F(", \"adc\":");
+    m += String(sample.adc)             + F(", \"temp\":");
+    m += String(sample.temp / 10.0)     + F(" }");
+  }
+
+  m += F(" ] }");
+
+  return (m);
+}
+
+static bool publish_samples(void) {
+  uint32_t now = duty_clock();
+  time_t time = clock_time();
+
+  while (p->state.count) {
+    int n = min(p->state.count, DUTY_CHUNK);
+
+    if (!telemetry_publish(F("batch"), format_samples(n, now, time))) {
+      return (false);
+    }
+
+    drop_samples(n);
+  }
+
+  return (true);
+}
+
+static void go_to_sleep(void) {
+  uint32_t awake = millis();
+  bool publish_next;
+
+  if (p->publishing) p->state.wakes = 0;
+
+  publish_next = ((p->state.wakes + 1) >= p->batch);
+
+  p->state.clock += (awake + 500) / 1000 + p->interval;
+  state_save(p->state);
+
+  log_print(F("DUTY: awake for %u ms, sleeping for %u s"), awake, p->interval);
+
+  // the radio is only calibrated when the next wake is going to publish
+  ESP.deepSleep(p->interval * 1000000,
+    publish_next ? WAKE_RF_DEFAULT : WAKE_RF_DISABLED
+  );
+}
+
+bool duty_cycling(void) {
+  return (p != NULL);
+}
+
+bool duty_publishing(void) {
+  if (!p) return (false);
+
+  return (p->publishing);
+}
+
+void duty_maintenance(void) {
+  if (!p) return;
+
+  log_print(F("DUTY: rebooting into maintenance mode"));
+
+  p->state.clock += millis() / 1000;
+  p->state.maintenance = 1;
+  state_save(p->state);
+
+  // a plain reboot would keep the radio off after a sample-only wake
+  ESP.deepSleep(1, WAKE_RF_DEFAULT);
+}
+
+int duty_state(void) {
+  if (p) return (MODULE_STATE_ACTIVE);
+
+  return (MODULE_STATE_INACTIVE);
+}
+
+bool duty_init(void) {
+  rst_info *info = ESP.getResetInfoPtr();
+  DutyState state;
+
+  if (p) return (false);
+
+  config_init();
+
+  if (bootup && !config->sleep_enabled) {
+    log_print(F("DUTY: deep sleep duty cycle disabled in config"));
+
+    config_fini();
+
+    return (false);
+  }
+
+  state_load(state);
+
+  // pressing reset (or the button while awake) asks for maintenance
+  if (state.maintenance || (info->reason == REASON_EXT_SYS_RST)) {
+    log_print(F("DUTY: maintenance mode, staying awake until reboot"));
+
+    state.maintenance = 0;
+    state_save(state);
+
+    config_fini();
+
+    return (false);
+  }
+
+  log_print(F("DUTY: initializing deep sleep duty cycle"));
+
+  p = (DUTY_PrivateData *)malloc(sizeof (DUTY_PrivateData));
+  memset(p, 0, sizeof (DUTY_PrivateData));
+
+  memcpy(&p->state, &state, sizeof (DutyState));
+
+  p->interval = config->sleep_interval;
+  p->batch    = config->sleep_batch;
+
+  config_fini();
+
+  pinMode(GPIO_BUTTON, INPUT);
+
+  take_sample();
+
+  p->publishing = (p->state.wakes >= p->batch);
+  p->publish_ms = millis();
+
+  if (p->publishing) {
+    log_print(F("DUTY: publishing %i samples"), p->state.count);
+  } else {
+    log_print(F("DUTY: sample %i of %i taken"), p->state.wakes, p->batch);
+  }
+
+  return (true);
+}
+
+bool duty_fini(void) {
+  if (!p) return (false);
+
+  log_print(F("DUTY: stopping deep sleep duty cycle"));
+
+  // the samples are kept for the next duty cycle
+  state_save(p->state);
+
+  free(p);
+  p = NULL;
+
+  return (true);
+}
+
+void duty_poll(void) {
+  if (!p) return;
+
+  if (digitalRead(GPIO_BUTTON) == LOW) {
+    duty_maintenance();
+  } else if (!p->publishing) {
+    go_to_sleep();
+  } else if (telemetry_connected()) {
+    if (publish_samples()) {
+      log_print(F("DUTY: samples published"));
+    } else {
+      log_print(F("DUTY: publishing failed, keeping %i samples"),
+        p->state.count
+      );
+    }
+
+    go_to_sleep();
+  } else if ((millis() - p->publish_ms) > DUTY_TIMEOUT) {
+    log_print(F("DUTY: broker not reachable, keeping %i samples"),
+      p->state.count
+    );
+
+    go_to_sleep();
+  }
+}
+
+MODULE(duty)
@@ -0,0 +1,40 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#ifndef _DUTY_H_
+#define _DUTY_H_
+
+// samples kept in RTC memory until they are published
+#define DUTY_SAMPLES 24
+
+// the timer wakes the chip through GPIO16, which must be wired to RST.
+// on the genesys board that pin also drives LED2 and the relais, so such
+// a board needs gpio_enabled=0. the button is read by duty.cpp itself.
+
+int duty_state(void);
+bool duty_init(void);
+bool duty_fini(void);
+void duty_poll(void);
+
+bool duty_cycling(void);
+bool duty_publishing(void);
+
+void duty_maintenance(void);
+
+#endif // _DUTY_H_
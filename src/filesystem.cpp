@@ -29,6 +29,7 @@ extern "C" uint32_t _SPIFFS_start;
 extern "C" uint32_t _SPIFFS_end;
 extern "C" uint32_t _SPIFFS_page;
 extern "C" uint32_t _SPIFFS_block;
+extern "C" uint32_t _CONFIG_sector0;
 
 FS *rootfs = NULL;
 
@@ -151,7 +152,7 @@ bool fs_init(void) {
   block  = (uint32_t) &_SPIFFS_block;
 
   ota_start = (used + FLASH_SECTOR_SIZE - 1) & (~(FLASH_SECTOR_SIZE - 1));
-  ota_end   = (uint32_t) &_SPIFFS_start - 0x40200000;
+  ota_end   = (uint32_t) &_CONFIG_sector0 - 0x40200000;
   ota_size  = ota_end - ota_start;
 
   if (ota_size > size) {
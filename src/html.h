@@ -36,40 +36,34 @@ enum {
   CONF_FOOTER
 };
 
-extern const char *html_page_style_css;
-
-extern const char *html_page_common_js;
-extern const char *html_page_config_js;
-extern const char *html_page_clock_js;
-extern const char *html_page_logo_js;
-extern const char *html_page_root_js;
-extern const char *html_page_sys_js;
+// the info page is rendered in that many parts
+#define INFO_PARTS 2
 
 bool html_init(void);
 
 void html_client_connected_via_softap(void);
 void html_client_connected_via_wifi(void);
 
-void html_insert_page_header(String &html);
-void html_insert_page_body(String &html, bool menu = true);
-void html_insert_page_footer(String &html);
+void html_insert_page_header(Print &out);
+void html_insert_page_body(Print &out, bool menu = true);
+void html_insert_page_footer(Print &out);
 
-void html_insert_login_content(String &html, const String &msg);
-void html_insert_file_content(String &html, const String &path);
-void html_insert_conf_content(String &html, int conf);
-void html_insert_root_content(String &html);
-void html_insert_clock_content(String &html);
-void html_insert_info_content(String &html);
-void html_insert_sys_content(String &html);
-void html_insert_log_content(String &html);
+void html_insert_login_content(Print &out, const String &msg);
+void html_insert_file_content(Print &out, const String &path);
+void html_insert_conf_content(Print &out, int conf);
+void html_insert_root_content(Print &out);
+void html_insert_clock_content(Print &out);
+void html_insert_info_content(Print &out, int part);
+void html_insert_sys_content(Print &out);
+void html_insert_log_content(Print &out);
 
-void html_insert_module_header(String &html);
-void html_insert_module_row(String &html, int module);
-void html_insert_module_footer(String &html);
+void html_insert_module_header(Print &out);
+void html_insert_module_row(Print &out, int module);
+void html_insert_module_footer(Print &out);
 
-void html_insert_websocket_script(String &html);
-void html_insert_upload_form(String &html);
+void html_insert_websocket_script(Print &out);
+void html_insert_upload_form(Print &out);
 
-void html_insert_wifi_list(String &html);
+void html_insert_wifi_list(Print &out);
 
 #endif // _HTML_H_
@@ -0,0 +1,1542 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#include <ESP8266WiFi.h>
+
+extern "C" {
+#include <lwip/opt.h>
+#include <lwip/tcp.h>
+#include <lwip/pbuf.h>
+}
+
+#include "system.h"
+#include "log.h"
+
+#include "httpd.h"
+
+//#define LOG_CONNECTIONS
+
+// leave room for the chunk size line and trailing CRLF in one segment
+#define HTTPD_CHUNK_SIZE (TCP_MSS - 8)
+
+// lwIP calls the tcp callbacks from the system context, where it is not
+// allowed to yield. the callbacks therefore only queue received pbufs and
+// record events, while parsing requests, calling the handlers and feeding
+// the send window is all done in HTTPServer::poll() from the main loop.
+//
+// connections are persistent (HTTP/1.1 keep-alive), requests that arrive
+// pipelined stay in the receive queue until the previous response is out.
+
+enum ConnState {
+  CONN_STATE_REQUEST,  // reading request line
+  CONN_STATE_HEADERS,  // reading request headers
+  CONN_STATE_BODY,     // reading request body
+  CONN_STATE_RESPONSE, // handler was called, draining the send queue
+};
+
+enum SegmentType {
+  SEGMENT_RAM,
+  SEGMENT_PGM,
+  SEGMENT_FILE
+};
+
+enum MultipartState {
+  MP_PREAMBLE,         // skip everything up to the first boundary
+  MP_BOUNDARY,         // boundary seen, expect CRLF or "--"
+  MP_HEADERS,          // reading part headers
+  MP_DATA,             // reading part data
+  MP_DONE              // closing boundary seen
+};
+
+struct Segment {
+  SegmentType type;
+
+  char       *ram;     // SEGMENT_RAM (owned copy)
+  const char *pgm;     // SEGMENT_PGM
+  File        file;    // SEGMENT_FILE
+  size_t      base;    // SEGMENT_FILE, file position of offset 0
+
+  size_t length;
+  size_t offset;
+
+  Segment *next;
+};
+
+struct HTTPRoute {
+  String uri;
+  HTTPMethod method;
+  HTTPHandler fn;
+  HTTPHandler upload;
+
+  uint32_t requests;
+
+  HTTPRoute *next;
+};
+
+struct HTTPConnection {
+  tcp_pcb *pcb;
+  uint32_t remote_ip;
+
+  ConnState state;
+  uint32_t last_activity;
+  bool remote_closed;
+  bool aborted;
+  int requests;
+
+  // receive queue (pbuf chain) and read offset into the first pbuf
+  pbuf *rx;
+  size_t rx_offset;
+
+  // request
+  String line;
+  HTTPMethod method;
+  String uri;
+  bool keep_alive;
+
+  String arg_name[HTTPD_MAX_ARGS];
+  String arg_value[HTTPD_MAX_ARGS];
+  int arg_count;
+
+  String header_value[HTTPD_MAX_HEADERS];
+
+  size_t content_length;
+  size_t content_received;
+  bool urlencoded;
+  bool multipart;
+  String body;
+
+  HTTPRoute *route;
+
+  // multipart/form-data parser
+  String delimiter;
+  MultipartState mp_state;
+  uint16_t mp_match;
+  char mp_prev;
+  String mp_name;
+  String mp_value;
+  bool mp_file;
+  HTTPUpload *upload;
+
+  // response
+  bool header_sent;
+  bool head_only;
+  bool chunked;
+  bool finished;
+  size_t response_length;
+  String response_headers;
+
+  Segment *head;
+  Segment *tail;
+
+  HTTPProducer producer;
+  int producer_arg;
+  int producer_step;
+
+  uint32_t started;    // micros() when the request was dispatched
+};
+
+struct HTTPD_PrivateData {
+  tcp_pcb *listen;
+
+  HTTPConnection *conn[HTTPD_MAX_CONNECTIONS];
+  HTTPConnection *current;
+
+  HTTPRoute *routes;
+  HTTPHandler not_found;
+
+  uint32_t unrouted;   // requests served by the not found handler
+  Histogram latency;   // from dispatch until handed to lwIP
+
+  String header_keys[HTTPD_MAX_HEADERS];
+  int header_count;
+
+  uint8_t txbuf[TCP_MSS];
+
+  // staging buffer for print()/write() to the current connection
+  uint8_t outbuf[HTTPD_CHUNK_SIZE];
+  size_t outlen;
+};
+
+static HTTPD_PrivateData *p = NULL;
+
+static const __FlashStringHelper *reason(int code) {
+  if (code == 200) return (F("OK"));
+  if (code == 206) return (F("Partial Content"));
+  if (code == 301) return (F("Moved Permanently"));
+  if (code == 302) return (F("Found"));
+  if (code == 304) return (F("Not Modified"));
+  if (code == 400) return (F("Bad Request"));
+  if (code == 401) return (F("Unauthorized"));
+  if (code == 403) return (F("Forbidden"));
+  if (code == 404) return (F("Not Found"));
+  if (code == 406) return (F("Not Acceptable"));
+  if (code == 413) return (F("Payload Too Large"));
+  if (code == 416) return (F("Range Not Satisfiable"));
+  if (code == 500) return (F("Internal Server Error"));
+  if (code == 503) return (F("Service Unavailable"));
+  if (code == 507) return (F("Insufficient Storage"));
+
+  return (F(""));
+}
+
+static String url_decode(const String &str) {
+  String ret;
+
+  ret.reserve(str.length());
+
+  for (int i=0; i<str.length(); i++) {
+    char c = str[i];
+
+    if (c == '+') {
+      c = ' ';
+    } else if ((c == '%') && (i + 2 < str.length())) {
+      char hex[3] = { str[i+1], str[i+2], '\0' };
+
+      c = strtol(hex, NULL, 16);
+      i += 2;
+    }
+
+    ret += c;
+  }
+
+  return (ret);
+}
+
+static void add_arg(HTTPConnection *c, const String &name, const String &value) {
+  if (c->arg_count == HTTPD_MAX_ARGS) {
+    log_print(F("HTTP: too many arguments, dropping '%s'"), name.c_str());
+
+    return;
+  }
+
+  c->arg_name[c->arg_count]  = name;
+  c->arg_value[c->arg_count] = value;
+  c->arg_count++;
+}
+
+static void parse_args(HTTPConnection *c, const String &query) {
+  int pos = 0;
+
+  while (pos < query.length()) {
+    int end = query.indexOf('&', pos);
+    if (end < 0) end = query.length();
+
+    String pair = query.substring(pos, end);
+    int eq = pair.indexOf('=');
+
+    if (eq < 0) {
+      if (pair.length()) add_arg(c, url_decode(pair), String());
+    } else {
+      add_arg(c,
+        url_decode(pair.substring(0, eq)), url_decode(pair.substring(eq + 1))
+      );
+    }
+
+    pos = end + 1;
+  }
+}
+
+static Segment *segment_new(HTTPConnection *c, SegmentType type, size_t len) {
+  Segment *s = new Segment();
+
+  s->type   = type;
+  s->ram    = NULL;
+  s->pgm    = NULL;
+  s->length = len;
+  s->offset = 0;
+  s->base   = 0;
+  s->next   = NULL;
+
+  if (c->tail) c->tail->next = s; else c->head = s;
+  c->tail = s;
+
+  return (s);
+}
+
+static void segment_pop(HTTPConnection *c) {
+  Segment *s = c->head;
+
+  c->head = s->next;
+  if (!c->head) c->tail = NULL;
+
+  if (s->type == SEGMENT_RAM)  free(s->ram);
+  if (s->type == SEGMENT_FILE) s->file.close();
+
+  delete (s);
+}
+
+// hand queued segments to lwIP as far as the send window allows,
+// the caller is responsible for tcp_output()
+static void conn_flush(HTTPConnection *c) {
+  while (c->head && c->pcb) {
+    Segment *s = c->head;
+    size_t room = tcp_sndbuf(c->pcb);
+    size_t len = s->length - s->offset;
+    const void *data = p->txbuf;
+
+    if ((room == 0) || (tcp_sndqueuelen(c->pcb) >= TCP_SND_QUEUELEN)) break;
+
+    if (len > room)    len = room;
+    if (len > TCP_MSS) len = TCP_MSS;
+
+    if (s->type == SEGMENT_RAM) {
+      data = s->ram + s->offset;
+    } else if (s->type == SEGMENT_PGM) {
+      memcpy_P(p->txbuf, s->pgm + s->offset, len);
+    } else {
+      len = s->file.read(p->txbuf, len);
+
+      if (len == 0) {
+        // file is shorter than announced, nothing more to send
+        segment_pop(c);
+
+        continue;
+      }
+    }
+
+    if (tcp_write(c->pcb, data, len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+      // out of memory in lwIP, retry on next poll
+      if (s->type == SEGMENT_FILE) {
+        s->file.seek(s->base + s->offset, SeekSet);
+      }
+
+      break;
+    }
+
+    s->offset += len;
+    c->last_activity = millis();
+
+    if (s->offset == s->length) segment_pop(c);
+  }
+}
+
+static void queue_ram(HTTPConnection *c, const char *data, size_t len) {
+  Segment *s;
+
+  if (len == 0) return;
+
+  if (c->head) conn_flush(c);
+
+  // bypass the queue if lwIP can take the data right away
+  if (!c->head && c->pcb && (len <= tcp_sndbuf(c->pcb)) &&
+     (tcp_sndqueuelen(c->pcb) < TCP_SND_QUEUELEN)) {
+    if (tcp_write(c->pcb, data, len, TCP_WRITE_FLAG_COPY) == ERR_OK) {
+      c->last_activity = millis();
+
+      return;
+    }
+  }
+
+  s = c->tail;
+
+  // small writes are appended to the last unsent RAM segment
+  if (s && (s->type == SEGMENT_RAM) && (s->offset == 0) &&
+     (s->length + len <= TCP_MSS)) {
+    char *buf = (char *)realloc(s->ram, s->length + len);
+
+    if (buf) {
+      memcpy(buf + s->length, data, len);
+
+      s->ram = buf;
+      s->length += len;
+
+      return;
+    }
+  }
+
+  char *buf = (char *)malloc(len);
+
+  if (!buf) {
+    log_print(F("HTTP: could not allocate %i bytes for send queue"), len);
+
+    return;
+  }
+
+  memcpy(buf, data, len);
+
+  segment_new(c, SEGMENT_RAM, len)->ram = buf;
+}
+
+static void queue_pgm(HTTPConnection *c, PGM_P data, size_t len) {
+  if (len == 0) return;
+
+  segment_new(c, SEGMENT_PGM, len)->pgm = data;
+}
+
+static void queue_file(HTTPConnection *c, File &file,
+                       size_t base, size_t len) {
+  Segment *s;
+
+  if (len == 0) return;
+
+  file.seek(base, SeekSet);
+
+  s = segment_new(c, SEGMENT_FILE, len);
+  s->file = file;
+  s->base = base;
+}
+
+static void out_flush(HTTPConnection *c);
+
+static void queue_content(HTTPConnection *c, const char *data,
+                          size_t len, bool pgm) {
+  // keep the order with data that was written through print()
+  out_flush(c);
+
+  if (c->head_only || (len == 0)) return;
+
+  if (c->chunked) {
+    char size[12];
+
+    snprintf_P(size, sizeof (size), PSTR("%x\r\n"), len);
+    queue_ram(c, size, strlen(size));
+  }
+
+  if (pgm) {
+    queue_pgm(c, data, len);
+  } else {
+    queue_ram(c, data, len);
+  }
+
+  if (c->chunked) queue_ram(c, "\r\n", 2);
+}
+
+static void out_flush(HTTPConnection *c) {
+  size_t len = p->outlen;
+
+  if (len == 0) return;
+
+  p->outlen = 0;
+
+  // every flush of the staging buffer becomes one chunk
+  queue_content(c, (const char *)p->outbuf, len, false);
+}
+
+static void end_response(HTTPConnection *c) {
+  out_flush(c);
+
+  if (c->chunked && !c->head_only) {
+    queue_ram(c, "0\r\n\r\n", 5);
+  }
+
+  c->finished = true;
+}
+
+static void reset_request(HTTPConnection *c) {
+  c->state            = CONN_STATE_REQUEST;
+  c->line             = String();
+  c->method           = HTTP_GET;
+  c->uri              = String();
+  c->keep_alive       = false;
+  c->content_length   = 0;
+  c->content_received = 0;
+  c->urlencoded       = false;
+  c->multipart        = false;
+  c->body             = String();
+  c->route            = NULL;
+  c->delimiter        = String();
+  c->mp_state         = MP_PREAMBLE;
+  c->mp_match         = 0;
+  c->mp_prev          = 0;
+  c->mp_name          = String();
+  c->mp_value         = String();
+  c->mp_file          = false;
+  c->header_sent      = false;
+  c->head_only        = false;
+  c->chunked          = false;
+  c->finished         = false;
+  c->response_length  = CONTENT_LENGTH_NOT_SET;
+  c->response_headers = String();
+  c->producer         = NULL;
+  c->producer_arg     = 0;
+  c->producer_step    = 0;
+
+  for (int i=0; i<c->arg_count; i++) {
+    c->arg_name[i]  = String();
+    c->arg_value[i] = String();
+  }
+  c->arg_count = 0;
+
+  for (int i=0; i<HTTPD_MAX_HEADERS; i++) {
+    c->header_value[i] = String();
+  }
+
+  delete (c->upload);
+  c->upload = NULL;
+}
+
+static void conn_free(HTTPConnection *c) {
+  if (c->pcb) {
+    tcp_arg(c->pcb,  NULL);
+    tcp_recv(c->pcb, NULL);
+    tcp_sent(c->pcb, NULL);
+    tcp_err(c->pcb,  NULL);
+
+    if (c->aborted) {
+      tcp_abort(c->pcb);
+    } else if (tcp_close(c->pcb) != ERR_OK) {
+      tcp_abort(c->pcb);
+    }
+
+    c->pcb = NULL;
+  }
+
+  if (c->rx) pbuf_free(c->rx);
+
+  while (c->head) segment_pop(c);
+
+  if (c->upload && (c->upload->status != UPLOAD_FILE_END)) {
+    HTTPConnection *current = p->current;
+
+    // let the upload handler clean up half written files
+    c->upload->status = UPLOAD_FILE_ABORTED;
+
+    if (c->route && c->route->upload) {
+      p->current = c;
+      c->route->upload();
+      p->current = current;
+    }
+  }
+
+  delete (c->upload);
+  delete (c);
+}
+
+static err_t tcp_recv_cb(void *arg, tcp_pcb *pcb, pbuf *pb, err_t err) {
+  HTTPConnection *c = (HTTPConnection *)arg;
+
+  if (!c) {
+    if (pb) {
+      tcp_recved(pcb, pb->tot_len);
+      pbuf_free(pb);
+    }
+
+    return (ERR_OK);
+  }
+
+  if (!pb) {
+    // remote side has closed the connection
+    c->remote_closed = true;
+
+    return (ERR_OK);
+  }
+
+  // data is acknowledged with tcp_recved() only after it has been
+  // parsed, thus the receive window throttles fast senders
+  if (c->rx) pbuf_cat(c->rx, pb); else c->rx = pb;
+
+  c->last_activity = millis();
+
+  return (ERR_OK);
+}
+
+static err_t tcp_sent_cb(void *arg, tcp_pcb *pcb, u16_t len) {
+  HTTPConnection *c = (HTTPConnection *)arg;
+
+  if (c) c->last_activity = millis();
+
+  return (ERR_OK);
+}
+
+static void tcp_err_cb(void *arg, err_t err) {
+  HTTPConnection *c = (HTTPConnection *)arg;
+
+  // the pcb has already been freed by lwIP
+  if (c) {
+    c->pcb = NULL;
+    c->aborted = true;
+  }
+}
+
+static err_t tcp_accept_cb(void *arg, tcp_pcb *pcb, err_t err) {
+  int slot = -1;
+
+  if (!p) return (ERR_VAL);
+
+  tcp_accepted(p->listen);
+
+  for (int i=0; i<HTTPD_MAX_CONNECTIONS; i++) {
+    if (!p->conn[i]) {
+      slot = i;
+      break;
+    }
+  }
+
+  if (slot < 0) {
+    // make room by closing a persistent connection waiting for a request
+    for (int i=0; i<HTTPD_MAX_CONNECTIONS; i++) {
+      HTTPConnection *c = p->conn[i];
+
+      if ((c->state == CONN_STATE_REQUEST) && !c->rx && !c->line.length()) {
+        conn_free(c);
+        p->conn[i] = NULL;
+        slot = i;
+
+        break;
+      }
+    }
+  }
+
+  if (slot < 0) {
+    // all slots are busy, the client will retry
+    tcp_abort(pcb);
+
+    return (ERR_ABRT);
+  }
+
+  HTTPConnection *c = new HTTPConnection();
+
+  c->pcb           = pcb;
+  c->remote_ip     = pcb->remote_ip.addr;
+  c->last_activity = millis();
+  c->remote_closed = false;
+  c->aborted       = false;
+  c->rx            = NULL;
+  c->rx_offset     = 0;
+  c->requests      = 0;
+  c->arg_count     = 0;
+  c->upload        = NULL;
+  c->head          = NULL;
+  c->tail          = NULL;
+
+  reset_request(c);
+
+  tcp_setprio(pcb, TCP_PRIO_MIN);
+  tcp_nagle_disable(pcb);
+
+  tcp_arg(pcb,  c);
+  tcp_recv(pcb, tcp_recv_cb);
+  tcp_sent(pcb, tcp_sent_cb);
+  tcp_err(pcb,  tcp_err_cb);
+
+  p->conn[slot] = c;
+
+  return (ERR_OK);
+}
+
+static void conn_consume(HTTPConnection *c, size_t len) {
+  c->rx_offset += len;
+
+  if (c->rx_offset >= c->rx->len) {
+    pbuf *pb = c->rx;
+    u16_t size = pb->len;
+
+    // pbuf_cat() took over the reference of the tail, pbuf_dechain()
+    // would drop it and free everything queued behind the first pbuf
+    c->rx = pb->next;
+    c->rx_offset = 0;
+
+    if (c->rx) pbuf_ref(c->rx);
+
+    pbuf_free(pb);
+
+    if (c->pcb) tcp_recved(c->pcb, size);
+  }
+}
+
+HTTPServer::HTTPServer(uint16_t port) : port(port) {
+  if (p) return;
+
+  p = new HTTPD_PrivateData();
+
+  p->listen       = NULL;
+  p->current      = NULL;
+  p->routes       = NULL;
+  p->not_found    = NULL;
+  p->unrouted     = 0;
+
+  memset(&p->latency, 0, sizeof (p->latency));
+  p->header_count = 0;
+  p->outlen       = 0;
+
+  for (int i=0; i<HTTPD_MAX_CONNECTIONS; i++) {
+    p->conn[i] = NULL;
+  }
+}
+
+HTTPServer::~HTTPServer(void) {
+  if (!p) return;
+
+  for (int i=0; i<HTTPD_MAX_CONNECTIONS; i++) {
+    if (p->conn[i]) conn_free(p->conn[i]);
+  }
+
+  if (p->listen) {
+    tcp_accept(p->listen, NULL);
+    tcp_close(p->listen);
+  }
+
+  while (p->routes) {
+    HTTPRoute *r = p->routes;
+
+    p->routes = r->next;
+    delete (r);
+  }
+
+  delete (p);
+  p = NULL;
+}
+
+bool HTTPServer::begin(void) {
+  tcp_pcb *pcb = tcp_new();
+
+  if (!pcb) return (false);
+
+  ip_set_option(pcb, SOF_REUSEADDR);
+
+  if (tcp_bind(pcb, IP_ADDR_ANY, port) != ERR_OK) {
+    log_print(F("HTTP: could not bind to port %i"), port);
+    tcp_close(pcb);
+
+    return (false);
+  }
+
+  p->listen = tcp_listen(pcb);
+
+  if (!p->listen) {
+    tcp_close(pcb);
+
+    return (false);
+  }
+
+  tcp_arg(p->listen, NULL);
+  tcp_accept(p->listen, tcp_accept_cb);
+
+  return (true);
+}
+
+void HTTPServer::on(const String &uri, HTTPHandler fn) {
+  on(uri, HTTP_ANY, fn, NULL);
+}
+
+void HTTPServer::on(const String &uri, HTTPMethod method, HTTPHandler fn) {
+  on(uri, method, fn, NULL);
+}
+
+void HTTPServer::on(const String &uri, HTTPMethod method,
+                    HTTPHandler fn, HTTPHandler upload) {
+  HTTPRoute *r = new HTTPRoute();
+
+  r->uri    = uri;
+  r->method = method;
+  r->fn     = fn;
+  r->upload = upload;
+  r->next   = NULL;
+
+  r->requests = 0;
+
+  // append, so routes are matched in the order they were registered
+  HTTPRoute **last = &p->routes;
+  while (*last) last = &(*last)->next;
+  *last = r;
+}
+
+void HTTPServer::onNotFound(HTTPHandler fn) {
+  p->not_found = fn;
+}
+
+void HTTPServer::collectHeaders(const char *keys[], size_t count) {
+  p->header_count = min((int)count, HTTPD_MAX_HEADERS);
+
+  for (int i=0; i<p->header_count; i++) {
+    p->header_keys[i] = keys[i];
+  }
+}
+
+const String &HTTPServer::uri(void) {
+  return (p->current->uri);
+}
+
+HTTPMethod HTTPServer::method(void) {
+  return (p->current->method);
+}
+
+int HTTPServer::args(void) {
+  return (p->current->arg_count);
+}
+
+String HTTPServer::arg(int i) {
+  if (i < 0 || i >= p->current->arg_count) return (String());
+
+  return (p->current->arg_value[i]);
+}
+
+String HTTPServer::argName(int i) {
+  if (i < 0 || i >= p->current->arg_count) return (String());
+
+  return (p->current->arg_name[i]);
+}
+
+String HTTPServer::arg(const String &name) {
+  HTTPConnection *c = p->current;
+
+  for (int i=0; i<c->arg_count; i++) {
+    if (c->arg_name[i] == name) return (c->arg_value[i]);
+  }
+
+  return (String());
+}
+
+bool HTTPServer::hasArg(const String &name) {
+  HTTPConnection *c = p->current;
+
+  for (int i=0; i<c->arg_count; i++) {
+    if (c->arg_name[i] == name) return (true);
+  }
+
+  return (false);
+}
+
+String HTTPServer::header(const String &name) {
+  for (int i=0; i<p->header_count; i++) {
+    if (p->header_keys[i].equalsIgnoreCase(name)) {
+      return (p->current->header_value[i]);
+    }
+  }
+
+  return (String());
+}
+
+bool HTTPServer::hasHeader(const String &name) {
+  return (header(name).length() != 0);
+}
+
+size_t HTTPServer::contentLength(void) {
+  return (p->current->content_length);
+}
+
+IPAddress HTTPServer::remoteIP(void) {
+  return (IPAddress(p->current->remote_ip));
+}
+
+bool HTTPServer::hasUpload(void) {
+  return (p->current->upload != NULL);
+}
+
+HTTPUpload &HTTPServer::upload(void) {
+  return (*p->current->upload);
+}
+
+void HTTPServer::setContentLength(size_t length) {
+  p->current->response_length = length;
+}
+
+void HTTPServer::sendHeader(const String &name, const String &value) {
+  HTTPConnection *c = p->current;
+
+  c->response_headers += name;
+  c->response_headers += F(": ");
+  c->response_headers += value;
+  c->response_headers += F("\r\n");
+}
+
+static void begin_response(HTTPConnection *c, int code,
+                           const String &type, size_t length) {
+  String h;
+
+  if (c->header_sent) return;
+
+  h.reserve(128 + c->response_headers.length());
+
+  h += F("HTTP/1.1 ");
+  h += code;
+  h += ' ';
+  h += reason(code);
+  h += F("\r\n");
+
+  if (type.length()) {
+    h += F("Content-Type: ");
+    h += type;
+    h += F("\r\n");
+  }
+
+  // a response sent before the request body has been read completely
+  // (e.g. an upload is refused) leaves the stream out of sync
+  if (c->state < CONN_STATE_RESPONSE) c->keep_alive = false;
+
+  if (c->requests >= HTTPD_MAX_REQUESTS) c->keep_alive = false;
+
+  // a 304 has no body and must not announce one
+  if (code == 304) {
+    c->head_only = true;
+  } else if (length != CONTENT_LENGTH_UNKNOWN) {
+    h += F("Content-Length: ");
+    h += length;
+    h += F("\r\n");
+  } else if (c->keep_alive) {
+    // the keep_alive flag implies HTTP/1.1, thus chunked encoding
+    h += F("Transfer-Encoding: chunked\r\n");
+    c->chunked = true;
+  }
+
+  h += c->response_headers;
+
+  if (c->keep_alive) {
+    h += F("Connection: keep-alive\r\n\r\n");
+  } else {
+    h += F("Connection: close\r\n\r\n");
+  }
+
+  queue_ram(c, h.c_str(), h.length());
+
+  c->response_headers = String();
+  c->response_length = length;
+  c->header_sent = true;
+}
+
+void HTTPServer::send(int code, const String &type, const String &content) {
+  HTTPConnection *c = p->current;
+  size_t length = c->response_length;
+
+  if (length == CONTENT_LENGTH_NOT_SET) length = content.length();
+
+  begin_response(c, code, type, length);
+
+  queue_content(c, content.c_str(), content.length(), false);
+}
+
+void HTTPServer::send_P(int code, PGM_P type, PGM_P content, size_t length) {
+  HTTPConnection *c = p->current;
+
+  begin_response(c, code, FPSTR(type), length);
+
+  queue_content(c, content, length, true);
+}
+
+void HTTPServer::sendContent(const String &content) {
+  HTTPConnection *c = p->current;
+
+  queue_content(c, content.c_str(), content.length(), false);
+}
+
+void HTTPServer::sendContent_P(PGM_P content, size_t length) {
+  HTTPConnection *c = p->current;
+
+  queue_content(c, content, length, true);
+}
+
+static bool is_number(const String &str) {
+  if (!str.length()) return (false);
+
+  for (int i=0; i<str.length(); i++) {
+    if (!isdigit(str[i])) return (false);
+  }
+
+  return (true);
+}
+
+// only a single range is supported, a request for several ranges gets
+// the whole file. returns 1 for a valid range, 0 if the range is to be
+// ignored and -1 if it cannot be satisfied
+static int parse_range(const String &range, size_t size,
+                       size_t &first, size_t &last) {
+  String spec, from, to;
+  int dash;
+
+  if (!range.startsWith(F("bytes="))) return (0);
+
+  spec = range.substring(6);
+  spec.trim();
+
+  dash = spec.indexOf('-');
+  if ((dash < 0) || (spec.indexOf(',') >= 0)) return (0);
+
+  from = spec.substring(0, dash);
+  to   = spec.substring(dash + 1);
+
+  if (!from.length()) {
+    // suffix range, the last n bytes
+    size_t n;
+
+    if (!is_number(to)) return (0);
+
+    n = to.toInt();
+    if ((n == 0) || (size == 0)) return (-1);
+    if (n > size) n = size;
+
+    first = size - n;
+    last  = size - 1;
+
+    return (1);
+  }
+
+  if (!is_number(from)) return (0);
+  if (to.length() && !is_number(to)) return (0);
+
+  first = from.toInt();
+  last  = (to.length()) ? to.toInt() : size - 1;
+
+  if (first >= size) return (-1);
+  if (last < first)  return (0);
+  if (last >= size)  last = size - 1;
+
+  return (1);
+}
+
+size_t HTTPServer::streamFile(File &file, const String &type,
+                              const String &etag) {
+  HTTPConnection *c = p->current;
+  size_t size = file.size();
+  size_t first = 0, last = 0;
+  int range = 0;
+
+  sendHeader(F("Accept-Ranges"), F("bytes"));
+
+  if (etag.length()) {
+    sendHeader(F("ETag"), etag);
+
+    if (header(F("If-None-Match")) == etag) {
+      begin_response(c, 304, String(), 0);
+
+      return (0);
+    }
+  }
+
+  // with If-Range the range only applies to the same version of the file
+  if (hasHeader(F("Range"))) {
+    if (!hasHeader(F("If-Range")) || (header(F("If-Range")) == etag)) {
+      range = parse_range(header(F("Range")), size, first, last);
+    }
+  }
+
+  if (range < 0) {
+    sendHeader(F("Content-Range"), String(F("bytes */")) + size);
+    begin_response(c, 416, String(), 0);
+
+    return (0);
+  }
+
+  if (range > 0) {
+    String cr = F("bytes ");
+
+    cr += first;
+    cr += '-';
+    cr += last;
+    cr += '/';
+    cr += size;
+
+    sendHeader(F("Content-Range"), cr);
+    size = last - first + 1;
+  }
+
+  begin_response(c, (range) ? 206 : 200, type, size);
+
+  // the send queue holds its own reference to the file,
+  // it is read chunk by chunk as the send window allows
+  if (!c->head_only) queue_file(c, file, first, size);
+
+  return (size);
+}
+
+size_t HTTPServer::write(uint8_t c) {
+  return (write(&c, 1));
+}
+
+size_t HTTPServer::write(const uint8_t *buf, size_t size) {
+  HTTPConnection *c = p->current;
+  size_t done = 0;
+
+  if (!c || c->head_only) return (size);
+
+  while (done < size) {
+    size_t len = min(size - done, sizeof (p->outbuf) - p->outlen);
+
+    memcpy(p->outbuf + p->outlen, buf + done, len);
+
+    p->outlen += len;
+    done += len;
+
+    if (p->outlen == sizeof (p->outbuf)) out_flush(c);
+  }
+
+  return (size);
+}
+
+void HTTPServer::produce(HTTPProducer fn, int arg) {
+  HTTPConnection *c = p->current;
+
+  c->producer      = fn;
+  c->producer_arg  = arg;
+  c->producer_step = 0;
+}
+
+int HTTPServer::connections(void) {
+  int n = 0;
+
+  for (int i=0; i<HTTPD_MAX_CONNECTIONS; i++) {
+    if (p->conn[i]) n++;
+  }
+
+  return (n);
+}
+
+int HTTPServer::routes(void) {
+  int n = 0;
+
+  for (HTTPRoute *r = p->routes; r; r = r->next) n++;
+
+  return (n);
+}
+
+bool HTTPServer::route(int i, String &uri, HTTPMethod &method,
+                       uint32_t &requests) {
+  HTTPRoute *r = p->routes;
+
+  while (r && (i-- > 0)) r = r->next;
+
+  if (!r) return (false);
+
+  uri      = r->uri;
+  method   = r->method;
+  requests = r->requests;
+
+  return (true);
+}
+
+uint32_t HTTPServer::unrouted(void) {
+  return (p->unrouted);
+}
+
+const Histogram &HTTPServer::latency(void) {
+  return (p->latency);
+}
+
+static HTTPRoute *find_route(HTTPConnection *c) {
+  for (HTTPRoute *r = p->routes; r; r = r->next) {
+    if (r->uri != c->uri) continue;
+
+    if (r->method == HTTP_ANY)  return (r);
+    if (r->method == c->method) return (r);
+
+    if ((r->method == HTTP_GET) && (c->method == HTTP_HEAD)) return (r);
+  }
+
+  return (NULL);
+}
+
+static void dispatch(HTTPServer *server, HTTPConnection *c) {
+  c->state = CONN_STATE_RESPONSE;
+  c->requests++;
+  c->started = micros();
+
+  if (c->route) {
+    c->route->requests++;
+  } else {
+    p->unrouted++;
+  }
+
+  p->current = c;
+
+  // an upload handler might already have sent an error response
+  if (!c->header_sent) {
+    if (c->route) {
+      c->route->fn();
+    } else if (p->not_found) {
+      p->not_found();
+    } else {
+      server->send(404, F("text/plain"), F("NOT FOUND"));
+    }
+  }
+
+  // the handler might have shut us down
+  if (!p) return;
+
+  out_flush(c);
+
+  if (!c->header_sent && !c->head && !c->producer) {
+    server->send(500, F("text/plain"), F("NO RESPONSE"));
+  }
+
+  if (!c->producer) end_response(c);
+
+  p->current = NULL;
+}
+
+static void upload_call(HTTPConnection *c, HTTPUploadStatus status) {
+  HTTPUpload *u = c->upload;
+
+  if (!u) return;
+
+  u->status = status;
+
+  if (status == UPLOAD_FILE_WRITE) {
+    if (u->currentSize == 0) return;
+
+    u->totalSize += u->currentSize;
+  }
+
+  if (c->route && c->route->upload) {
+    p->current = c;
+    c->route->upload();
+    p->current = NULL;
+  }
+
+  if (status == UPLOAD_FILE_WRITE) u->currentSize = 0;
+}
+
+static void multipart_byte(HTTPConnection *c, char b) {
+  if (c->mp_state != MP_DATA) return;
+
+  if (c->mp_file) {
+    HTTPUpload *u = c->upload;
+
+    u->buf[u->currentSize++] = b;
+
+    if (u->currentSize == HTTPD_UPLOAD_BUFLEN) {
+      upload_call(c, UPLOAD_FILE_WRITE);
+    }
+  } else if (c->mp_value.length() < HTTPD_MAX_POST) {
+    c->mp_value += b;
+  }
+}
+
+static void multipart_part_begin(HTTPConnection *c) {
+  if (c->mp_file) {
+    if (!c->upload) c->upload = new HTTPUpload();
+
+    c->upload->name        = c->mp_name;
+    c->upload->totalSize   = 0;
+    c->upload->currentSize = 0;
+
+    upload_call(c, UPLOAD_FILE_START);
+  } else {
+    c->mp_value = String();
+  }
+}
+
+static void multipart_part_end(HTTPConnection *c) {
+  if (c->mp_file) {
+    upload_call(c, UPLOAD_FILE_WRITE);
+    upload_call(c, UPLOAD_FILE_END);
+  } else {
+    add_arg(c, c->mp_name, c->mp_value);
+    c->mp_value = String();
+  }
+
+  c->mp_name = String();
+  c->mp_file = false;
+}
+
+static void multipart_header(HTTPConnection *c, const String &line) {
+  String lower = line;
+
+  lower.toLowerCase();
+
+  if (lower.startsWith(F("content-disposition:"))) {
+    int idx = line.indexOf(F("name=\""));
+
+    if (idx >= 0) {
+      c->mp_name = line.substring(idx + 6, line.indexOf('"', idx + 6));
+    }
+
+    idx = line.indexOf(F("filename=\""));
+
+    if (idx >= 0) {
+      String filename = line.substring(idx + 10, line.indexOf('"', idx + 10));
+
+      c->mp_file = true;
+      if (!c->upload) c->upload = new HTTPUpload();
+      c->upload->filename = filename;
+      c->upload->type     = String();
+    }
+  } else if (lower.startsWith(F("content-type:")) && c->mp_file) {
+    c->upload->type = line.substring(13);
+    c->upload->type.trim();
+  }
+}
+
+static void parse_multipart(HTTPConnection *c, const uint8_t *data, size_t len) {
+  const char *delim = c->delimiter.c_str();
+  uint16_t delim_len = c->delimiter.length();
+
+  for (size_t i=0; i<len; i++) {
+    char b = data[i];
+
+    if ((c->mp_state == MP_PREAMBLE) || (c->mp_state == MP_DATA)) {
+      if (b == delim[c->mp_match]) {
+        if (++c->mp_match == delim_len) {
+          if (c->mp_state == MP_DATA) multipart_part_end(c);
+
+          c->mp_state = MP_BOUNDARY;
+          c->mp_match = 0;
+          c->mp_prev  = 0;
+        }
+
+        continue;
+      }
+
+      if (c->mp_match) {
+        // the partial delimiter match was part of the payload
+        for (int j=0; j<c->mp_match; j++) multipart_byte(c, delim[j]);
+
+        c->mp_match = (b == delim[0]) ? 1 : 0;
+
+        if (c->mp_match) continue;
+      }
+
+      multipart_byte(c, b);
+    } else if (c->mp_state == MP_BOUNDARY) {
+      if ((c->mp_prev == '-') && (b == '-')) {
+        c->mp_state = MP_DONE;
+      } else if ((c->mp_prev == '\r') && (b == '\n')) {
+        c->mp_state = MP_HEADERS;
+        c->line = String();
+      }
+
+      c->mp_prev = b;
+    } else if (c->mp_state == MP_HEADERS) {
+      if (b == '\n') {
+        if (c->line.length() == 0) {
+          c->mp_state = MP_DATA;
+          c->mp_match = 0;
+
+          multipart_part_begin(c);
+        } else {
+          multipart_header(c, c->line);
+        }
+
+        c->line = String();
+      } else if ((b != '\r') && (c->line.length() < HTTPD_MAX_LINE)) {
+        c->line += b;
+      }
+    }
+  }
+}
+
+static void parse_request_line(HTTPConnection *c) {
+  int sp1 = c->line.indexOf(' ');
+  int sp2 = c->line.indexOf(' ', sp1 + 1);
+
+  String method = c->line.substring(0, sp1);
+  String url    = c->line.substring(sp1 + 1, sp2);
+
+  // HTTP/1.1 connections are persistent unless the client says otherwise
+  c->keep_alive = (c->line.substring(sp2 + 1) == F("HTTP/1.1"));
+
+       if (method == F("GET"))  c->method = HTTP_GET;
+  else if (method == F("POST")) c->method = HTTP_POST;
+  else if (method == F("HEAD")) c->method = HTTP_HEAD;
+  else                          c->method = HTTP_ANY;
+
+  c->head_only = (c->method == HTTP_HEAD);
+
+  int q = url.indexOf('?');
+
+  if (q >= 0) {
+    c->uri = url_decode(url.substring(0, q));
+    parse_args(c, url.substring(q + 1));
+  } else {
+    c->uri = url_decode(url);
+  }
+}
+
+static void parse_header_line(HTTPConnection *c) {
+  int colon = c->line.indexOf(':');
+
+  if (colon <= 0) return;
+
+  String name  = c->line.substring(0, colon);
+  String value = c->line.substring(colon + 1);
+
+  value.trim();
+
+  if (name.equalsIgnoreCase(F("Connection"))) {
+    if (value.equalsIgnoreCase(F("close"))) c->keep_alive = false;
+  } else if (name.equalsIgnoreCase(F("Content-Length"))) {
+    c->content_length = value.toInt();
+  } else if (name.equalsIgnoreCase(F("Content-Type"))) {
+    if (value.startsWith(F("application/x-www-form-urlencoded"))) {
+      c->urlencoded = true;
+    } else if (value.startsWith(F("multipart/form-data"))) {
+      int idx = value.indexOf(F("boundary="));
+
+      if (idx >= 0) {
+        String boundary = value.substring(idx + 9);
+
+        boundary.replace(F("\""), F(""));
+
+        // the first boundary is not preceded by CRLF, thus the
+        // parser starts as if it had already matched those two
+        c->delimiter = F("\r\n--");
+        c->delimiter += boundary;
+        c->multipart = true;
+        c->mp_state  = MP_PREAMBLE;
+        c->mp_match  = 2;
+      }
+    }
+  }
+
+  for (int i=0; i<p->header_count; i++) {
+    if (p->header_keys[i].equalsIgnoreCase(name)) {
+      c->header_value[i] = value;
+    }
+  }
+}
+
+// returns the number of bytes consumed from data
+static size_t parse(HTTPServer *server, HTTPConnection *c,
+                    const uint8_t *data, size_t len) {
+  size_t i = 0;
+
+  while ((i < len) && (c->state < CONN_STATE_BODY)) {
+    char b = data[i++];
+
+    if (b == '\n') {
+      if (c->state == CONN_STATE_REQUEST) {
+        if (c->line.length()) {
+          parse_request_line(c);
+          c->state = CONN_STATE_HEADERS;
+        }
+      } else if (c->line.length() == 0) {
+        // end of headers
+        c->route = find_route(c);
+        c->state = CONN_STATE_BODY;
+      } else {
+        parse_header_line(c);
+      }
+
+      c->line = String();
+    } else if (b != '\r') {
+      if (c->line.length() >= HTTPD_MAX_LINE) {
+        // the error is the response, it is timed like one
+        c->started = micros();
+
+        p->current = c;
+        server->send(400, F("text/plain"), F("LINE TOO LONG"));
+        p->current = NULL;
+
+        c->state = CONN_STATE_RESPONSE;
+        c->finished = true;
+
+        return (len);
+      }
+
+      c->line += b;
+    }
+  }
+
+  if (c->state == CONN_STATE_BODY) {
+    size_t left = c->content_length - c->content_received;
+    size_t n = min(len - i, left);
+
+    if (c->multipart) {
+      parse_multipart(c, &data[i], n);
+    } else if (c->urlencoded) {
+      if (c->body.length() + n <= HTTPD_MAX_POST) {
+        c->body.concat((const char *)&data[i], n);
+      }
+    }
+
+    c->content_received += n;
+    i += n;
+
+    if (c->content_received >= c->content_length) {
+      if (c->urlencoded) parse_args(c, c->body);
+
+      c->body = String();
+
+      dispatch(server, c);
+    }
+  }
+
+  return (i);
+}
+
+void HTTPServer::poll(void) {
+  for (int i=0; i<HTTPD_MAX_CONNECTIONS; i++) {
+    HTTPConnection *c = p->conn[i];
+
+    if (!c) continue;
+
+    // read as much as possible of the pending request
+    while (c->rx && c->pcb && (c->state < CONN_STATE_RESPONSE)) {
+      const uint8_t *data = (const uint8_t *)c->rx->payload + c->rx_offset;
+      size_t len = c->rx->len - c->rx_offset;
+
+      conn_consume(c, parse(this, c, data, len));
+
+      if (!p) return; // a handler has shut the server down
+    }
+
+    if (c->state == CONN_STATE_RESPONSE) {
+      conn_flush(c);
+
+      // ask the producer for more as soon as the queue has drained
+      if (!c->head && c->producer && c->pcb) {
+        p->current = c;
+
+        if (!c->producer(c->producer_step++, c->producer_arg)) {
+          c->producer = NULL;
+
+          if (p) end_response(c);
+        }
+
+        if (!p) return;
+
+        out_flush(c);
+
+        p->current = NULL;
+
+        conn_flush(c);
+      }
+
+      if (c->pcb) tcp_output(c->pcb);
+
+      // response is complete when everything is handed to lwIP
+      if (c->finished && !c->head) {
+        metrics_observe(p->latency, micros() - c->started);
+
+#ifdef LOG_CONNECTIONS
+        log_print(F("HTTP: [%i] served %s (request %i)"),
+          i, c->uri.c_str(), c->requests
+        );
+#endif
+        if (!c->keep_alive) {
+          conn_free(c);
+          p->conn[i] = NULL;
+
+          continue;
+        }
+
+        // wait for the next (maybe already pipelined) request
+        reset_request(c);
+        c->last_activity = millis();
+      }
+    }
+
+    bool idle = (c->state == CONN_STATE_REQUEST) && !c->line.length();
+    uint32_t timeout = (idle) ? HTTPD_IDLE_TIMEOUT : HTTPD_TIMEOUT;
+
+    bool gone = c->remote_closed && !c->rx && (c->state < CONN_STATE_RESPONSE);
+
+    if (c->aborted || gone) {
+      conn_free(c);
+      p->conn[i] = NULL;
+    } else if ((millis() - c->last_activity) > timeout) {
+#ifdef LOG_CONNECTIONS
+      log_print(F("HTTP: [%i] connection timed out"), i);
+#endif
+      // idle persistent connections are closed gracefully
+      if (!idle) c->aborted = true;
+
+      conn_free(c);
+      p->conn[i] = NULL;
+    }
+  }
+}
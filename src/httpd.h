@@ -0,0 +1,153 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#ifndef _HTTPD_H_
+#define _HTTPD_H_
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <FS.h>
+
+#include "metrics.h"
+
+#define HTTPD_MAX_CONNECTIONS     4
+#define HTTPD_MAX_ARGS           32
+#define HTTPD_MAX_HEADERS         6
+#define HTTPD_MAX_LINE          512
+#define HTTPD_MAX_POST         2048
+#define HTTPD_UPLOAD_BUFLEN    2048 // multiple of the SPIFFS page size
+#define HTTPD_MAX_REQUESTS       32 // per connection
+#define HTTPD_TIMEOUT         10000 // ms
+#define HTTPD_IDLE_TIMEOUT     5000 // ms
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#define CONTENT_LENGTH_NOT_SET ((size_t) -2)
+
+enum HTTPMethod {
+  HTTP_ANY,
+  HTTP_GET,
+  HTTP_POST,
+  HTTP_HEAD
+};
+
+enum HTTPUploadStatus {
+  UPLOAD_FILE_START,
+  UPLOAD_FILE_WRITE,
+  UPLOAD_FILE_END,
+  UPLOAD_FILE_ABORTED
+};
+
+struct HTTPUpload {
+  HTTPUploadStatus status;
+
+  String filename;
+  String name;
+  String type;
+
+  size_t totalSize;
+  size_t currentSize;
+
+  uint8_t buf[HTTPD_UPLOAD_BUFLEN];
+};
+
+typedef void (*HTTPHandler)(void);
+
+// a producer is called each time the send queue of its connection
+// has drained, it appends the next part of the response and returns
+// false when there is nothing left to send
+typedef bool (*HTTPProducer)(int step, int arg);
+
+// print() to the server writes to the response of the current connection
+class HTTPServer : public Print {
+
+public:
+
+  HTTPServer(uint16_t port = 80);
+  ~HTTPServer(void);
+
+  bool begin(void);
+  void poll(void);
+
+  // routing
+  void on(const String &uri, HTTPHandler fn);
+  void on(const String &uri, HTTPMethod method, HTTPHandler fn);
+  void on(const String &uri, HTTPMethod method, HTTPHandler fn,
+          HTTPHandler upload);
+  void onNotFound(HTTPHandler fn);
+
+  void collectHeaders(const char *keys[], size_t count);
+
+  // request of the connection currently being served
+  const String &uri(void);
+  HTTPMethod method(void);
+
+  int args(void);
+  String arg(int i);
+  String argName(int i);
+  String arg(const String &name);
+  bool hasArg(const String &name);
+
+  String header(const String &name);
+  bool hasHeader(const String &name);
+
+  size_t contentLength(void);
+
+  IPAddress remoteIP(void);
+
+  // each connection has its own, a handler may compare their addresses
+  // to tell concurrent uploads apart
+  bool hasUpload(void);
+  HTTPUpload &upload(void);
+
+  // response of the connection currently being served
+  void setContentLength(size_t length);
+  void sendHeader(const String &name, const String &value);
+
+  void send(int code, const String &type, const String &content);
+  void send_P(int code, PGM_P type, PGM_P content, size_t length);
+
+  void sendContent(const String &content);
+  void sendContent_P(PGM_P content, size_t length);
+
+  // supports single byte ranges (Range/If-Range) and, given an etag,
+  // If-None-Match
+  size_t streamFile(File &file, const String &type,
+                    const String &etag = String());
+
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buf, size_t size);
+  using Print::write;
+
+  void produce(HTTPProducer fn, int arg = 0);
+
+  int connections(void);
+
+  // statistics, routes are numbered in the order they were registered
+  int routes(void);
+  bool route(int i, String &uri, HTTPMethod &method, uint32_t &requests);
+  uint32_t unrouted(void);
+  const Histogram &latency(void);
+
+private:
+
+  uint16_t port;
+
+};
+
+#endif // _HTTPD_H_
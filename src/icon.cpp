@@ -1,204 +0,0 @@
-/*
-    This file is part of Genesys.
-
-    Genesys is free software: you can redistribute it and/or modify
-    it under the terms of the GNU General Public License as published by
-    the Free Software Foundation, either version 3 of the License, or
-    (at your option) any later version.
-
-    Genesys is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU General Public License for more details.
-
-    You should have received a copy of the GNU General Public License
-    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
-
-    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
-*/
-
-#include <Arduino.h>
-
-int fav_len  = 592;
-int save_len = 315;
-int view_len = 514;
-int del_len  = 388;
-
-const char *fav_png  = NULL;
-const char *save_png = NULL;
-const char *view_png = NULL;
-const char *del_png  = NULL;
-
-PROGMEM const char fav_data[] = {
-  0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
-  0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10,
-  0x08, 0x06, 0x00, 0x00, 0x00, 0x1f, 0xf3, 0xff, 0x61, 0x00, 0x00, 0x00,
-  0x06, 0x62, 0x4b, 0x47, 0x44, 0x00, 0x22, 0x00, 0x20, 0x00, 0x7b, 0xbd,
-  0xd8, 0x29, 0x4f, 0x00, 0x00, 0x00, 0x09, 0x70, 0x48, 0x59, 0x73, 0x00,
-  0x00, 0x0b, 0x13, 0x00, 0x00, 0x0b, 0x13, 0x01, 0x00, 0x9a, 0x9c, 0x18,
-  0x00, 0x00, 0x00, 0x07, 0x74, 0x49, 0x4d, 0x45, 0x07, 0xe0, 0x07, 0x0a,
-  0x08, 0x2c, 0x29, 0x72, 0x9d, 0x2f, 0x2c, 0x00, 0x00, 0x01, 0xdd, 0x49,
-  0x44, 0x41, 0x54, 0x38, 0xcb, 0x85, 0xd3, 0xbf, 0x6b, 0x54, 0x41, 0x10,
-  0x07, 0xf0, 0xcf, 0xee, 0x7b, 0x17, 0x2e, 0x46, 0x23, 0xc2, 0xc9, 0x81,
-  0x48, 0x40, 0x92, 0x42, 0x2c, 0x52, 0x78, 0x88, 0xa0, 0x4d, 0x02, 0x62,
-  0x69, 0x61, 0x6b, 0x23, 0xe2, 0x0f, 0xb8, 0x46, 0x0b, 0x6b, 0x0b, 0xd3,
-  0x5a, 0x04, 0xc4, 0x67, 0xa3, 0xfe, 0x01, 0xf6, 0x5a, 0xd8, 0x98, 0x4a,
-  0x41, 0x12, 0x8b, 0x40, 0x50, 0x14, 0x11, 0x25, 0x08, 0x22, 0x62, 0x08,
-  0xb9, 0x20, 0xe6, 0xee, 0xd6, 0xe2, 0xde, 0xc5, 0x17, 0x11, 0x33, 0xcb,
-  0x32, 0x33, 0x3b, 0x7c, 0x87, 0x99, 0xd9, 0xf9, 0x42, 0x56, 0xb9, 0xf5,
-  0x8a, 0x6d, 0xde, 0xbc, 0x70, 0x3a, 0x4c, 0xc1, 0x24, 0xd9, 0x6d, 0xc6,
-  0x0b, 0x7e, 0x16, 0xfc, 0xb8, 0x17, 0xc2, 0x4d, 0x08, 0x76, 0x4a, 0x8e,
-  0xee, 0xd0, 0x49, 0x92, 0x59, 0xb3, 0x87, 0x17, 0x2c, 0xac, 0x42, 0x41,
-  0xc2, 0x0f, 0x7c, 0x47, 0x03, 0xb7, 0xa2, 0xff, 0xc8, 0x88, 0x11, 0x0b,
-  0x16, 0x52, 0x09, 0xde, 0x40, 0x77, 0x53, 0xad, 0xd9, 0x6e, 0x5e, 0x3b,
-  0x8a, 0xf7, 0x98, 0xdb, 0x91, 0x20, 0x94, 0x05, 0xcd, 0x98, 0x01, 0x5b,
-  0xb6, 0xe4, 0xa4, 0xfb, 0x3c, 0xc3, 0x18, 0xa6, 0xdf, 0x69, 0x74, 0x5b,
-  0x5f, 0x17, 0x63, 0xe0, 0x3a, 0xc6, 0x63, 0x59, 0x76, 0x8e, 0x3c, 0x49,
-  0x79, 0x92, 0xc2, 0x73, 0xcf, 0x4d, 0x99, 0xca, 0x23, 0x79, 0x97, 0x75,
-  0xcc, 0x10, 0xae, 0xf4, 0x79, 0xfb, 0x52, 0x03, 0xdc, 0x61, 0x31, 0x85,
-  0x50, 0xd8, 0x4d, 0xee, 0xf3, 0xad, 0x60, 0xad, 0xe0, 0x72, 0x32, 0x38,
-  0x27, 0x9c, 0xa8, 0x0d, 0xe3, 0x71, 0xb7, 0x04, 0x89, 0x0e, 0xf6, 0xb7,
-  0x79, 0x10, 0x04, 0x2d, 0xad, 0xd0, 0xd7, 0xdf, 0x31, 0xf5, 0x26, 0xd4,
-  0x63, 0x9d, 0x3d, 0x42, 0x63, 0xa3, 0x91, 0x56, 0xad, 0xca, 0xd0, 0x1b,
-  0xfc, 0xc8, 0x81, 0x37, 0xc2, 0x99, 0x5c, 0x6a, 0xe6, 0xea, 0x56, 0xac,
-  0xc8, 0x64, 0x21, 0x93, 0xa5, 0x9e, 0xde, 0xae, 0xe5, 0xa7, 0x82, 0xf5,
-  0x47, 0x1c, 0xa9, 0xbe, 0x9f, 0x77, 0x3e, 0xdb, 0x6e, 0xa1, 0x60, 0xef,
-  0xdf, 0xc0, 0x62, 0x70, 0x4f, 0x25, 0xd6, 0x12, 0x9d, 0x4b, 0x7c, 0x1c,
-  0xc6, 0x5a, 0x5a, 0xe1, 0x93, 0x4f, 0xb1, 0x3a, 0x83, 0xb9, 0xcf, 0x7f,
-  0x2d, 0x54, 0x7b, 0xa0, 0x9e, 0x22, 0x3e, 0x64, 0xb6, 0x1a, 0x1b, 0x35,
-  0x9a, 0xaa, 0x7e, 0xc4, 0x8d, 0x09, 0xd2, 0xa4, 0x49, 0x99, 0x6c, 0x14,
-  0xf9, 0x3c, 0x67, 0xcb, 0xf9, 0x84, 0xd7, 0x6c, 0x96, 0xab, 0x9d, 0x23,
-  0x7f, 0xe1, 0x45, 0x9e, 0x24, 0x2d, 0xad, 0xda, 0xb4, 0xe9, 0x5a, 0xc4,
-  0x66, 0xc1, 0x97, 0x0f, 0x3e, 0xe8, 0xe9, 0x6d, 0xa1, 0x3b, 0xc2, 0x05,
-  0xd4, 0xda, 0x8c, 0x97, 0xab, 0xdd, 0x2b, 0x75, 0xb7, 0xaf, 0x3f, 0x5c,
-  0xf5, 0xfe, 0xb2, 0xe5, 0xad, 0x88, 0x8b, 0xd8, 0x57, 0x70, 0xa0, 0xec,
-  0xff, 0x09, 0xce, 0xe1, 0xf1, 0xd5, 0x41, 0x6b, 0xe1, 0x5f, 0x03, 0x5e,
-  0xb2, 0xd4, 0xdb, 0x26, 0x53, 0x49, 0x92, 0x75, 0x7c, 0x2b, 0x49, 0xb2,
-  0xbf, 0xfd, 0x07, 0x78, 0x08, 0x5f, 0xaa, 0xe0, 0x31, 0x63, 0xb1, 0xa3,
-  0xd3, 0x87, 0x78, 0xfc, 0x64, 0x33, 0x7f, 0x45, 0x3d, 0xc5, 0x78, 0x05,
-  0x07, 0x53, 0x08, 0x77, 0x7f, 0x71, 0x6c, 0x62, 0xd0, 0xf3, 0x90, 0xda,
-  0xb1, 0x4a, 0xfb, 0x8e, 0xce, 0xb6, 0xfd, 0x1b, 0x5a, 0xec, 0x90, 0x38,
-  0xe2, 0x0e, 0xe4, 0xe8, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44,
-  0xae, 0x42, 0x60, 0x82
-};
-
-PROGMEM const char save_data[] = {
-  0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
-  0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x20,
-  0x08, 0x06, 0x00, 0x00, 0x00, 0x73, 0x7a, 0x7a, 0xf4, 0x00, 0x00, 0x00,
-  0x06, 0x62, 0x4b, 0x47, 0x44, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0xa0,
-  0xbd, 0xa7, 0x93, 0x00, 0x00, 0x00, 0x09, 0x70, 0x48, 0x59, 0x73, 0x00,
-  0x00, 0x0b, 0x13, 0x00, 0x00, 0x0b, 0x13, 0x01, 0x00, 0x9a, 0x9c, 0x18,
-  0x00, 0x00, 0x00, 0x07, 0x74, 0x49, 0x4d, 0x45, 0x07, 0xe0, 0x07, 0x0d,
-  0x0d, 0x08, 0x1b, 0xd0, 0xbe, 0x65, 0x58, 0x00, 0x00, 0x00, 0xc8, 0x49,
-  0x44, 0x41, 0x54, 0x58, 0xc3, 0xed, 0x96, 0x3d, 0x0a, 0x83, 0x40, 0x10,
-  0x46, 0x5f, 0x52, 0x78, 0x06, 0xc1, 0xc3, 0x78, 0x00, 0xc1, 0x2a, 0xf7,
-  0xf0, 0x78, 0x69, 0x03, 0x01, 0xc1, 0xd6, 0x2a, 0x37, 0xd8, 0x03, 0xa4,
-  0x12, 0x36, 0x98, 0x66, 0x90, 0xc5, 0x44, 0xfc, 0x1d, 0xb7, 0x99, 0x0f,
-  0xa6, 0x91, 0x61, 0xde, 0xb7, 0x3b, 0x33, 0x8b, 0x60, 0x32, 0x99, 0x4c,
-  0xdb, 0x95, 0x03, 0x8d, 0x44, 0x1e, 0xc3, 0x80, 0x03, 0x7a, 0x09, 0xb7,
-  0xb5, 0xc8, 0x65, 0x87, 0x81, 0xfe, 0x88, 0x5a, 0xd7, 0xd8, 0x7d, 0x34,
-  0x03, 0x66, 0x60, 0x8d, 0x81, 0x02, 0x78, 0x05, 0xab, 0xf7, 0x6f, 0x2b,
-  0x7a, 0xc9, 0x29, 0xb4, 0xf7, 0x7e, 0x2e, 0x9c, 0xc6, 0x0d, 0x7c, 0x94,
-  0x72, 0x17, 0xab, 0x04, 0xfc, 0x82, 0xd3, 0x7b, 0xad, 0x16, 0x00, 0xdc,
-  0x66, 0x4c, 0x78, 0xc9, 0x51, 0xd5, 0x94, 0x89, 0xee, 0x0c, 0xf8, 0x94,
-  0x89, 0x53, 0xe1, 0xe1, 0x4c, 0x38, 0x89, 0xd2, 0xfe, 0x4e, 0xf6, 0xa8,
-  0x1b, 0x0d, 0x53, 0xa6, 0xc8, 0xca, 0x46, 0xac, 0x37, 0x40, 0x3d, 0xfa,
-  0x78, 0x07, 0x52, 0x05, 0x78, 0x2a, 0xb5, 0x43, 0x56, 0x0d, 0x50, 0xad,
-  0x78, 0x62, 0x8f, 0x8e, 0x0a, 0x20, 0x01, 0xda, 0x08, 0xf0, 0x56, 0xd8,
-  0x43, 0x6f, 0xda, 0x93, 0xe1, 0x3f, 0xb3, 0x96, 0xc8, 0x95, 0x3c, 0x14,
-  0xc1, 0x4f, 0x61, 0x0c, 0x27, 0xff, 0x02, 0x8c, 0x74, 0xbd, 0x58, 0x6a,
-  0x3c, 0x5f, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae,
-  0x42, 0x60, 0x82
-};
-
-PROGMEM const char view_data[] = {
-  0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
-  0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x20,
-  0x08, 0x06, 0x00, 0x00, 0x00, 0x73, 0x7a, 0x7a, 0xf4, 0x00, 0x00, 0x00,
-  0x06, 0x62, 0x4b, 0x47, 0x44, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0xa0,
-  0xbd, 0xa7, 0x93, 0x00, 0x00, 0x00, 0x09, 0x70, 0x48, 0x59, 0x73, 0x00,
-  0x00, 0x0b, 0x13, 0x00, 0x00, 0x0b, 0x13, 0x01, 0x00, 0x9a, 0x9c, 0x18,
-  0x00, 0x00, 0x00, 0x07, 0x74, 0x49, 0x4d, 0x45, 0x07, 0xe0, 0x07, 0x0d,
-  0x0d, 0x1a, 0x34, 0x03, 0x9b, 0x28, 0xd2, 0x00, 0x00, 0x01, 0x8f, 0x49,
-  0x44, 0x41, 0x54, 0x58, 0xc3, 0xed, 0x97, 0xcf, 0x66, 0x03, 0x51, 0x14,
-  0xc6, 0x7f, 0xa9, 0x0a, 0xa1, 0x74, 0x15, 0x42, 0x08, 0x25, 0xab, 0x30,
-  0x84, 0x52, 0x86, 0xd0, 0x67, 0xe8, 0xaa, 0xf4, 0x19, 0xba, 0xca, 0xb6,
-  0xab, 0x3e, 0x40, 0x18, 0xf2, 0x0e, 0xd5, 0x0a, 0x59, 0x65, 0x5b, 0xba,
-  0x4d, 0x29, 0x95, 0x45, 0x37, 0xa9, 0x2c, 0x2a, 0xd5, 0x55, 0x29, 0x5d,
-  0x54, 0x49, 0x4d, 0x37, 0x5f, 0x98, 0x8c, 0xc9, 0xcc, 0xb9, 0x49, 0x6a,
-  0x16, 0xcd, 0xc7, 0x21, 0xdc, 0x6f, 0xce, 0x39, 0xf7, 0xfc, 0xbd, 0x29,
-  0x84, 0x61, 0x48, 0x9e, 0xd8, 0x21, 0x67, 0x6c, 0x1d, 0xc8, 0xdd, 0x81,
-  0xdc, 0x51, 0x70, 0xe0, 0x56, 0x81, 0x33, 0xe0, 0x10, 0xa8, 0x03, 0x0d,
-  0xa0, 0xa4, 0xb3, 0x2f, 0xe0, 0x09, 0x78, 0x06, 0x1e, 0x80, 0x2b, 0xe0,
-  0x75, 0x13, 0x0e, 0x16, 0x81, 0x73, 0x60, 0x08, 0x84, 0x8e, 0x32, 0xd4,
-  0xb7, 0xc5, 0x55, 0x8d, 0x9f, 0x00, 0xe3, 0x15, 0x0c, 0xc7, 0x65, 0x2c,
-  0x5d, 0x66, 0x94, 0x80, 0xde, 0x06, 0x0c, 0xc7, 0xa5, 0x17, 0x49, 0xd9,
-  0x52, 0x54, 0x0c, 0xe1, 0xfe, 0x06, 0xba, 0xc0, 0xb1, 0xc2, 0x5b, 0xd4,
-  0xef, 0xae, 0xce, 0xb2, 0xd2, 0x52, 0x59, 0x66, 0xbc, 0x6c, 0x08, 0xf9,
-  0x14, 0x68, 0xa6, 0x5c, 0xa0, 0x29, 0x4e, 0x56, 0x4a, 0xca, 0x49, 0xc5,
-  0x66, 0xb9, 0xb9, 0x27, 0xfe, 0x81, 0x42, 0x3a, 0x95, 0x5c, 0xab, 0x4b,
-  0x10, 0xc7, 0x12, 0x89, 0x85, 0xe2, 0xec, 0x18, 0x72, 0xd8, 0x8d, 0xf0,
-  0x2f, 0x12, 0xce, 0xdf, 0xd5, 0x9a, 0x88, 0x9b, 0xa5, 0xaf, 0x33, 0x57,
-  0xe6, 0x03, 0x33, 0xc3, 0x07, 0xad, 0x58, 0xd4, 0x2e, 0x13, 0x38, 0x7d,
-  0x9d, 0xb5, 0x0c, 0xfa, 0x66, 0xc0, 0x11, 0xc0, 0x9d, 0xb1, 0x8a, 0x93,
-  0xfa, 0x39, 0xee, 0xc4, 0x67, 0x24, 0xa5, 0x16, 0x9d, 0xb7, 0xbb, 0xc0,
-  0x8f, 0xe3, 0x7c, 0xf8, 0x00, 0xf6, 0x0d, 0x03, 0xcc, 0x0c, 0x6b, 0x0a,
-  0x7c, 0xf1, 0xfb, 0x29, 0x9c, 0x7e, 0x44, 0xa7, 0x25, 0x05, 0xbe, 0x4b,
-  0x11, 0x06, 0xe2, 0x36, 0x54, 0x70, 0x69, 0x45, 0x18, 0xb8, 0x14, 0xe1,
-  0x7c, 0xfa, 0xb9, 0xb4, 0x61, 0x55, 0x6d, 0xf8, 0x26, 0xe9, 0xad, 0xdb,
-  0x86, 0x2e, 0x83, 0xc8, 0x4b, 0x49, 0xa7, 0xb7, 0xea, 0x20, 0x9a, 0xa3,
-  0x06, 0x8c, 0x0c, 0x91, 0x08, 0x34, 0x7e, 0x89, 0xb4, 0x5d, 0x60, 0xb8,
-  0xf9, 0x48, 0x36, 0x52, 0xb1, 0x07, 0x0c, 0xfe, 0x60, 0x19, 0x0d, 0xa4,
-  0xdb, 0x69, 0x1d, 0x4f, 0x36, 0x60, 0x78, 0xe2, 0xba, 0x8e, 0xe3, 0xc5,
-  0xd9, 0x5e, 0xe3, 0x41, 0xd2, 0xce, 0x5a, 0xc1, 0x2e, 0x4f, 0xb2, 0x1a,
-  0x70, 0xaa, 0xf1, 0x59, 0x4f, 0xd8, 0x8a, 0x8f, 0x7a, 0x92, 0xdd, 0x03,
-  0x37, 0xc0, 0x0b, 0x5b, 0x58, 0x5e, 0xc5, 0xdb, 0xff, 0x86, 0xff, 0xde,
-  0x81, 0x5f, 0xe8, 0x3c, 0x6e, 0x83, 0xa1, 0x4f, 0x91, 0x8f, 0x00, 0x00,
-  0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82
-};
-
-PROGMEM const char del_data[] = {
-  0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
-  0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x20,
-  0x08, 0x06, 0x00, 0x00, 0x00, 0x73, 0x7a, 0x7a, 0xf4, 0x00, 0x00, 0x00,
-  0x06, 0x62, 0x4b, 0x47, 0x44, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0xa0,
-  0xbd, 0xa7, 0x93, 0x00, 0x00, 0x00, 0x09, 0x70, 0x48, 0x59, 0x73, 0x00,
-  0x00, 0x0b, 0x13, 0x00, 0x00, 0x0b, 0x13, 0x01, 0x00, 0x9a, 0x9c, 0x18,
-  0x00, 0x00, 0x00, 0x07, 0x74, 0x49, 0x4d, 0x45, 0x07, 0xe0, 0x07, 0x0d,
-  0x0d, 0x1a, 0x01, 0x55, 0x28, 0xec, 0xf1, 0x00, 0x00, 0x01, 0x11, 0x49,
-  0x44, 0x41, 0x54, 0x58, 0xc3, 0xed, 0x97, 0x41, 0x0a, 0x83, 0x30, 0x10,
-  0x45, 0x5f, 0xa4, 0x78, 0x06, 0xa1, 0xf7, 0xe8, 0xb6, 0xdb, 0x1e, 0x46,
-  0xe8, 0xf1, 0xda, 0x4d, 0x21, 0x20, 0x08, 0xae, 0x0a, 0x5e, 0xc2, 0x0b,
-  0x74, 0x63, 0x41, 0xd2, 0xcd, 0x08, 0x36, 0x55, 0x49, 0xd2, 0xc6, 0x96,
-  0xe2, 0xc0, 0xdf, 0x4c, 0x4c, 0xfe, 0x73, 0x18, 0x34, 0x83, 0x31, 0x06,
-  0xcf, 0x48, 0x81, 0x1c, 0xd0, 0x40, 0x2b, 0xd2, 0x92, 0x4b, 0x7d, 0x0f,
-  0xc3, 0x13, 0x60, 0x0b, 0x5c, 0x01, 0x33, 0xa1, 0xab, 0x3c, 0x13, 0x05,
-  0x20, 0x05, 0xea, 0x19, 0xf3, 0x5e, 0xb5, 0x57, 0x25, 0x3c, 0x00, 0x72,
-  0x07, 0xf3, 0x5e, 0x79, 0x0c, 0x80, 0xc2, 0x32, 0xd1, 0xc0, 0x4e, 0xa4,
-  0xad, 0xb5, 0x22, 0x06, 0x40, 0x6b, 0x99, 0x64, 0x83, 0xb5, 0xcc, 0x5a,
-  0x6b, 0x43, 0x00, 0xf6, 0x40, 0xe5, 0x51, 0xe6, 0x50, 0x55, 0xe2, 0xf5,
-  0x02, 0xd0, 0x2c, 0x60, 0xde, 0xab, 0xe9, 0x4d, 0x93, 0x41, 0x31, 0x3a,
-  0x96, 0x8b, 0x6e, 0xac, 0x02, 0x87, 0x85, 0xaa, 0xd0, 0x88, 0x17, 0x00,
-  0xca, 0x18, 0x83, 0x52, 0xea, 0xa9, 0x2d, 0x2c, 0x5a, 0xf5, 0xe6, 0xdb,
-  0xce, 0x9e, 0x97, 0xf0, 0xe5, 0x58, 0x01, 0x42, 0x00, 0x2e, 0x22, 0xd7,
-  0xfc, 0x6c, 0x84, 0x34, 0xa1, 0x09, 0xcc, 0xaf, 0x4d, 0xb8, 0x02, 0xac,
-  0x00, 0xbf, 0x09, 0xb0, 0x09, 0xd8, 0x73, 0xf6, 0xcc, 0x7f, 0xfc, 0x43,
-  0xf4, 0xff, 0x7f, 0xc3, 0xfb, 0xc8, 0x30, 0x12, 0x1a, 0xf6, 0xde, 0x9b,
-  0xcb, 0xad, 0xb8, 0xb4, 0x6e, 0x30, 0x27, 0xeb, 0x06, 0xec, 0x1a, 0x99,
-  0xec, 0x1d, 0x9e, 0x55, 0xba, 0x00, 0x1c, 0x23, 0x5e, 0xc7, 0x8e, 0x2e,
-  0x00, 0xae, 0x23, 0x98, 0xaf, 0xc6, 0x47, 0xb6, 0x89, 0xc1, 0x64, 0xfb,
-  0x61, 0x88, 0x7a, 0xb2, 0x97, 0x66, 0x26, 0xa3, 0x54, 0x4a, 0xa6, 0xdf,
-  0x30, 0x2e, 0xe4, 0x8c, 0xc9, 0x61, 0xf5, 0x01, 0xb9, 0xc0, 0x1f, 0x4e,
-  0x08, 0x2e, 0x0a, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44,
-  0xae, 0x42, 0x60, 0x82
-};
-
-bool icon_init(void) {
-  fav_png  = fav_data;
-  save_png = save_data;
-  view_png = view_data;
-  del_png  = del_data;
-
-  return (true);
-}
@@ -0,0 +1,255 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+extern "C" {
+#include <spi_flash.h>
+}
+
+#include "util.h"
+#include "log.h"
+
+#include "journal.h"
+
+#define JOURNAL_MAGIC 0x314a4e47 // "GNJ1"
+
+extern "C" uint32_t _CONFIG_sector0;
+extern "C" uint32_t _CONFIG_sector1;
+
+// the sectors are not adjacent, they sit on either side of SPIFFS
+static const uint32_t *sectors[] = { &_CONFIG_sector0, &_CONFIG_sector1 };
+
+// at the start of each sector, written last when a sector is compacted
+struct JournalHeader {
+  uint32_t magic;
+  uint32_t seq;          // the highest one is the active sector
+};
+
+// followed by len bytes of data, padded to 4 bytes
+struct JournalRecord {
+  uint32_t key;
+  uint8_t  len;
+  uint8_t  reserved;
+  uint16_t crc;          // lower half of the CRC-32 of key, len and data
+};
+
+static int sector = -1;        // active sector, -1 if there is none
+static uint32_t seq = 0;
+static uint32_t offset = 0;    // where the next record goes
+static uint32_t failures = 0;  // appends that didn't make it
+
+// a record was cut short (power loss), nothing may be appended after it
+static bool torn = false;
+
+// the first sector is in use by an OTA image
+static bool reserved = false;
+
+static int sector_count(void) {
+  return (sizeof (sectors) / sizeof (sectors[0]));
+}
+
+static uint32_t sector_addr(int s) {
+  return ((uint32_t)sectors[s] - 0x40200000);
+}
+
+static uint32_t padded(uint8_t len) {
+  return ((len + 3) & ~3);
+}
+
+static uint16_t record_crc(const JournalRecord &record, const void *data) {
+  uint32_t crc;
+
+  crc = crc32_update(0,   &record.key, sizeof (record.key));
+  crc = crc32_update(crc, &record.len, sizeof (record.len));
+  crc = crc32_update(crc, data,        record.len);
+
+  return (crc & 0xFFFF);
+}
+
+static bool flash_read(uint32_t addr, void *data, uint32_t len) {
+  return (spi_flash_read(addr, (uint32_t *)data, len) == SPI_FLASH_RESULT_OK);
+}
+
+static bool flash_write(uint32_t addr, const void *data, uint32_t len) {
+  SpiFlashOpResult ret;
+
+  noInterrupts();
+  ret = spi_flash_write(addr, (uint32_t *)data, len);
+  interrupts();
+
+  return (ret == SPI_FLASH_RESULT_OK);
+}
+
+static bool flash_erase(int s) {
+  SpiFlashOpResult ret;
+
+  noInterrupts();
+  ret = spi_flash_erase_sector(sector_addr(s) / SPI_FLASH_SEC_SIZE);
+  interrupts();
+
+  return (ret == SPI_FLASH_RESULT_OK);
+}
+
+int journal_load(void (*cb)(uint32_t key, const uint8_t *data, uint8_t len)) {
+  uint32_t data[(JOURNAL_MAX_LEN + 3) / 4];
+  JournalHeader header;
+  JournalRecord record;
+  int records = 0;
+
+  sector = -1;
+
+  for (int s=0; s<sector_count(); s++) {
+    if (!flash_read(sector_addr(s), &header, sizeof (header))) continue;
+    if (header.magic != JOURNAL_MAGIC) continue;
+
+    if ((sector < 0) || ((int32_t)(header.seq - seq) > 0)) {
+      sector = s;
+      seq = header.seq;
+    }
+  }
+
+  if (sector < 0) return (-1);
+
+  offset = sizeof (JournalHeader);
+  torn = false;
+
+  while ((offset + sizeof (record)) <= SPI_FLASH_SEC_SIZE) {
+    uint32_t addr = sector_addr(sector) + offset;
+
+    flash_read(addr, &record, sizeof (record));
+
+    // erased flash, end of the journal
+    if ((record.key == 0xFFFFFFFF) && (record.len == 0xFF)) break;
+
+    if ((offset + sizeof (record) + padded(record.len)) > SPI_FLASH_SEC_SIZE) {
+      torn = true;
+      break;
+    }
+
+    flash_read(addr + sizeof (record), data, padded(record.len));
+
+    if (record.crc != record_crc(record, data)) {
+      torn = true;
+      break;
+    }
+
+    cb(record.key, (uint8_t *)data, record.len);
+
+    offset += sizeof (record) + padded(record.len);
+    records++;
+  }
+
+  if (torn) {
+    log_print(F("JRNL: broken record at offset %u, compacting"), offset);
+  }
+
+  return (records);
+}
+
+bool journal_append(uint32_t key, const void *data, uint8_t len) {
+  uint32_t buf[(sizeof (JournalRecord) + JOURNAL_MAX_LEN + 3) / 4];
+  JournalRecord *record = (JournalRecord *)buf;
+  uint32_t size = sizeof (JournalRecord) + padded(len);
+
+  if ((sector < 0) || torn || ((offset + size) > SPI_FLASH_SEC_SIZE)) {
+    failures++;
+
+    return (false);
+  }
+
+  // padding stays erased
+  memset(buf, 0xFF, size);
+  memcpy(record + 1, data, len);
+
+  record->key = key;
+  record->len = len;
+  record->crc = record_crc(*record, record + 1);
+
+  if (!flash_write(sector_addr(sector) + offset, buf, size)) {
+    log_print(F("JRNL: flash write error"));
+
+    failures++;
+    torn = true;
+
+    return (false);
+  }
+
+  offset += size;
+
+  return (true);
+}
+
+bool journal_compact(void (*cb)(void)) {
+  int next = (sector < 0) ? 0 : (sector + 1) % sector_count();
+  JournalHeader header = { JOURNAL_MAGIC, seq + 1 };
+  uint32_t old_offset = offset;
+  uint32_t old_failures = failures;
+  int old_sector = sector;
+
+  // while an update is staged only the second sector is left
+  if (reserved && (next == 0)) next = 1;
+
+  if (next == sector) {
+    log_print(F("JRNL: no sector left while an update is staged"));
+
+    return (false);
+  }
+
+  if (!flash_erase(next)) {
+    log_print(F("JRNL: flash erase error"));
+
+    return (false);
+  }
+
+  // the snapshot goes into a sector without header, until it is complete
+  // a power loss leaves the old sector active
+  sector = next;
+  offset = sizeof (JournalHeader);
+  torn = false;
+
+  cb();
+
+  if ((failures != old_failures) ||
+      !flash_write(sector_addr(next), &header, sizeof (header))) {
+    log_print(F("JRNL: compaction failed"));
+
+    // the old sector stays active, the next write tries again
+    sector = old_sector;
+    offset = old_offset;
+    torn = true;
+
+    return (false);
+  }
+
+  seq++;
+
+  return (true);
+}
+
+void journal_reserve(bool reserve) {
+  reserved = reserve;
+}
+
+int journal_sector(void) {
+  return (sector);
+}
+
+void journal_usage(int &total, int &used) {
+  total = SPI_FLASH_SEC_SIZE;
+  used  = (sector < 0) ? 0 : offset;
+}
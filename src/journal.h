@@ -0,0 +1,51 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#ifndef _JOURNAL_H_
+#define _JOURNAL_H_
+
+#include <Arduino.h>
+
+// An append-only key/value journal in the flash sectors _CONFIG_sector0 and
+// _CONFIG_sector1. Records carry a CRC, the last record of a key wins. When
+// a sector is full, journal_compact() writes a snapshot to the next one.
+
+#define JOURNAL_MAX_LEN 255
+
+// replays the active sector, returns the number of records or -1 if no
+// sector holds a journal yet
+int journal_load(void (*cb)(uint32_t key, const uint8_t *data, uint8_t len));
+
+// false if the record doesn't fit into the active sector
+bool journal_append(uint32_t key, const void *data, uint8_t len);
+
+// cb appends the current state of all keys, that sector becomes active
+// only after cb returned
+bool journal_compact(void (*cb)(void));
+
+// an OTA image is staged right below SPIFFS and overwrites the first
+// sector, while it is reserved journal_compact() doesn't go there
+void journal_reserve(bool reserve);
+
+// the active sector, -1 if there is none
+int journal_sector(void);
+
+void journal_usage(int &total, int &used);
+
+#endif // _JOURNAL_H_
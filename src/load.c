@@ -18,6 +18,7 @@
 */
 
 #include <user_interface.h>
+#include <spi_flash.h>
 #include <lwip/err.h>
 #include <stdint.h>
 
@@ -29,7 +30,10 @@ extern void  __real_free(void *);
 extern void  __real_tcp_recved(struct tcp_pcb *, u16_t);
 extern err_t __real_tcp_write(struct tcp_pcb *, const void *, u16_t, u8_t);
 
+extern SpiFlashOpResult __real_spi_flash_write(uint32, uint32 *, uint32);
+
 extern uint32_t mem_free, traffic_count;
+extern uint32_t rx_bytes, tx_bytes, flash_writes;
 
 static void (*out_of_memory_cb)(void) = NULL;
 
@@ -86,11 +90,25 @@ void __wrap_free(void *ptr) {
 
 void __wrap_tcp_recved(struct tcp_pcb *pcb, u16_t len) {
   traffic_count += len;
+  rx_bytes += len;
   __real_tcp_recved(pcb, len);
 }
 
 err_t __wrap_tcp_write(struct tcp_pcb *pcb, const void *arg,
                        u16_t len, u8_t apiflags) {
-  traffic_count += len;
-  __real_tcp_write(pcb, arg, len, apiflags);
+  err_t err = __real_tcp_write(pcb, arg, len, apiflags);
+
+  // only count what lwIP actually accepted
+  if (err == ERR_OK) {
+    traffic_count += len;
+    tx_bytes += len;
+  }
+
+  return (err);
+}
+
+SpiFlashOpResult __wrap_spi_flash_write(uint32 addr, uint32 *src, uint32 size) {
+  flash_writes++;
+
+  return (__real_spi_flash_write(addr, src, size));
 }
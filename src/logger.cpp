@@ -476,6 +476,14 @@ void logger_dump_html(String &str, int lines) {
   str += F("</pre>");
 }
 
+// text of the line that was logged back lines ago, NULL if there is none.
+// also called from the crash handler, so it must not allocate anything.
+const char *logger_line(int back) {
+  if (!p || (back < 0) || (back >= p->log_lines_count)) return (NULL);
+
+  return (log_line(p->log_lines_count - 1 - back).text);
+}
+
 #else // QUIET
 
 int logger_state(void) {
@@ -503,6 +511,10 @@ bool logger_print(const char *str, uint16_t len, uint8_t col) {
 void logger_dump_html(String &str, int lines) {}
 void logger_dump_raw(String &str, int lines) {}
 
+const char *logger_line(int back) {
+  return (NULL);
+}
+
 #endif // QUIET
 
 MODULE(logger)
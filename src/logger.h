@@ -39,4 +39,6 @@ bool logger_progress(const char *str, uint16_t len);
 void logger_dump_html(String &str, int lines = -1);
 void logger_dump_raw(String &str, int lines = -1);
 
+const char *logger_line(int back);
+
 #endif // _LOGGER_H_
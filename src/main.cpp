@@ -24,13 +24,16 @@
 #include "storage.h"
 #include "console.h"
 #include "at24c32.h"
+#include "metrics.h"
 #include "system.h"
 #include "logger.h"
 #include "telnet.h"
 #include "module.h"
 #include "config.h"
 #include "update.h"
+#include "crash.h"
 #include "clock.h"
+#include "duty.h"
 #include "gpio.h"
 #include "mdns.h"
 #include "rtc.h"
@@ -80,22 +83,32 @@ bool main_init(void) {
   console_init();
   system_init();
   logger_init();
+  crash_init();
   cli_init();
   i2c_init();
   rtc_init();
-  gpio_init();
-  led_init();
-  net_init();
-  ntp_init();
-  webserver_init();
-  websocket_init();
-  telemetry_init();
-  storage_init();
-  update_init();
-  mdns_init();
-  telnet_init();
-
-  led_on(LED_GRN);
+
+  // a duty cycle takes a sample and only every so often publishes them
+  if (duty_init()) {
+    if (duty_publishing()) {
+      net_init();
+      telemetry_init();
+    }
+  } else {
+    gpio_init();
+    led_init();
+    net_init();
+    ntp_init();
+    webserver_init();
+    websocket_init();
+    telemetry_init();
+    storage_init();
+    update_init();
+    mdns_init();
+    telnet_init();
+
+    led_on(LED_GRN);
+  }
 
   config_fini();
   bootup = false;
@@ -107,6 +120,8 @@ bool main_init(void) {
 
 bool main_fini(void) {
   config_fini();
+  crash_fini();
+  duty_fini();
   ntp_fini();
   rtc_fini();
   mdns_fini();
@@ -129,21 +144,27 @@ bool main_fini(void) {
 }
 
 void main_loop(void) {
-  config_poll();
-  rtc_poll();
-  websocket_poll();
-  telemetry_poll();
-  webserver_poll();
-  update_poll();
-  gpio_poll();
-  ntp_poll();
-  net_poll();
-  mdns_poll();
-  storage_poll();
-  telnet_poll();
-  console_poll();
-  led_poll();
-  system_poll();
-  logger_poll();
-  fs_poll();
+  CRASH_POLL(config);
+  CRASH_POLL(rtc);
+  CRASH_POLL(websocket);
+  CRASH_POLL(telemetry);
+  CRASH_POLL(webserver);
+  CRASH_POLL(update);
+  CRASH_POLL(gpio);
+  CRASH_POLL(ntp);
+  CRASH_POLL(net);
+  CRASH_POLL(mdns);
+  CRASH_POLL(storage);
+  CRASH_POLL(telnet);
+  CRASH_POLL(console);
+  CRASH_POLL(led);
+  CRASH_POLL(system);
+  CRASH_POLL(metrics);
+  CRASH_POLL(logger);
+  CRASH_POLL(fs);
+  CRASH_POLL(duty);
+  CRASH_POLL(crash);
+
+  // whatever crashes from here on runs outside of the main loop
+  crash_module = NULL;
 }
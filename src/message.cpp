@@ -0,0 +1,63 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#include "log.h"
+
+#include "message.h"
+
+Message *message_new(uint16_t reserve, uint16_t head) {
+  Message *msg = new Message();
+
+  if (!msg) return (NULL);
+
+  msg->head = head;
+  msg->refs = 1;
+
+  if (!msg->data.reserve(reserve + head)) {
+    log_print(F("MSG:  could not allocate %i bytes"), reserve + head);
+  }
+
+  // headroom is filled with blanks, so the payload can be
+  // appended with the usual String operators
+  for (int i=0; i<head; i++) msg->data += ' ';
+
+  return (msg);
+}
+
+Message *message_ref(Message *msg) {
+  if (msg) msg->refs++;
+
+  return (msg);
+}
+
+void message_unref(Message *msg) {
+  if (!msg) return;
+
+  if (--msg->refs == 0) {
+    delete (msg);
+  }
+}
+
+const char *message_payload(const Message *msg) {
+  return (msg->data.c_str() + msg->head);
+}
+
+uint16_t message_length(const Message *msg) {
+  return (msg->data.length() - msg->head);
+}
@@ -0,0 +1,41 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#ifndef _MESSAGE_H_
+#define _MESSAGE_H_
+
+#include <Arduino.h>
+
+// A message is serialized exactly once and then handed to every receiver
+// by reference. The last receiver to drop its reference frees the buffer.
+
+struct Message {
+  String   data;   // headroom + payload
+  uint16_t head;   // bytes reserved in front of the payload
+  uint8_t  refs;   // reference count
+};
+
+Message *message_new(uint16_t reserve, uint16_t head = 0);
+Message *message_ref(Message *msg);
+void message_unref(Message *msg);
+
+const char *message_payload(const Message *msg);
+uint16_t message_length(const Message *msg);
+
+#endif // _MESSAGE_H_
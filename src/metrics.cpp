@@ -0,0 +1,232 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#include <Arduino.h>
+
+extern "C" {
+#include <umm_malloc/umm_malloc.h>
+}
+
+#include "telemetry.h"
+#include "system.h"
+#include "module.h"
+#include "httpd.h"
+#include "net.h"
+
+#include "metrics.h"
+
+// umm_malloc manages the heap in blocks of 8 bytes
+#define HEAP_BLOCK_SIZE 8
+
+// counted by the linker wrappers in load.c
+uint32_t rx_bytes = 0, tx_bytes = 0, flash_writes = 0;
+
+static const uint32_t PROGMEM bucket_bounds[METRICS_BUCKETS] = {
+  1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000
+};
+
+static uint32_t loop_count = 0;
+static Histogram loop_time;
+
+void metrics_observe(Histogram &h, uint32_t us) {
+  int i = 0;
+
+  while ((i < METRICS_BUCKETS) && (us > pgm_read_dword(&bucket_bounds[i]))) {
+    i++;
+  }
+
+  h.count[i]++;
+  h.sum += us;
+}
+
+void metrics_poll(void) {
+  static uint32_t last = micros();
+  uint32_t now = micros();
+
+  // time for one round of the main loop, including yield()
+  metrics_observe(loop_time, now - last);
+  loop_count++;
+
+  last = now;
+}
+
+static void print_seconds(Print &out, uint64_t us) {
+  char buf[24];
+
+  snprintf_P(buf, sizeof (buf), PSTR("%lu.%06lu"),
+    (unsigned long)(us / 1000000), (unsigned long)(us % 1000000)
+  );
+
+  out.print(buf);
+}
+
+static void print_type(Print &out, PGM_P name, PGM_P type) {
+  out.print(F("# TYPE "));
+  out.print(FPSTR(name));
+  out.print(' ');
+  out.print(FPSTR(type));
+  out.print('\n');
+}
+
+static void print_counter(Print &out, PGM_P name, uint32_t value) {
+  print_type(out, name, PSTR("counter"));
+
+  out.print(FPSTR(name));
+  out.print(' ');
+  out.print(value);
+  out.print('\n');
+}
+
+static void print_gauge(Print &out, PGM_P name, long value) {
+  print_type(out, name, PSTR("gauge"));
+
+  out.print(FPSTR(name));
+  out.print(' ');
+  out.print(value);
+  out.print('\n');
+}
+
+static void print_histogram(Print &out, PGM_P name, const Histogram &h) {
+  uint32_t count = 0;
+
+  print_type(out, name, PSTR("histogram"));
+
+  // prometheus buckets are cumulative
+  for (int i=0; i<=METRICS_BUCKETS; i++) {
+    count += h.count[i];
+
+    out.print(FPSTR(name));
+    out.print(F("_bucket{le=\""));
+    if (i < METRICS_BUCKETS) {
+      print_seconds(out, pgm_read_dword(&bucket_bounds[i]));
+    } else {
+      out.print(F("+Inf"));
+    }
+    out.print(F("\"} "));
+    out.print(count);
+    out.print('\n');
+  }
+
+  out.print(FPSTR(name));
+  out.print(F("_sum "));
+  print_seconds(out, h.sum);
+  out.print('\n');
+
+  out.print(FPSTR(name));
+  out.print(F("_count "));
+  out.print(count);
+  out.print('\n');
+}
+
+static void print_routes(HTTPServer &server) {
+  PGM_P name = PSTR("genesys_http_requests_total");
+  uint32_t requests;
+  HTTPMethod method;
+  String uri;
+
+  print_type(server, name, PSTR("counter"));
+
+  for (int i=0; server.route(i, uri, method, requests); i++) {
+    server.print(FPSTR(name));
+    server.print(F("{route=\""));
+    server.print(uri);
+    server.print(F("\",method=\""));
+         if (method == HTTP_GET)  server.print(F("GET"));
+    else if (method == HTTP_POST) server.print(F("POST"));
+    else                          server.print(F("ANY"));
+    server.print(F("\"} "));
+    server.print(requests);
+    server.print('\n');
+  }
+
+  server.print(FPSTR(name));
+  server.print(F("{route=\"\",method=\"ANY\"} "));
+  server.print(server.unrouted());
+  server.print('\n');
+}
+
+static void print_modules(Print &out) {
+  PGM_P name = PSTR("genesys_module_active");
+
+  print_type(out, name, PSTR("gauge"));
+
+  for (int i=0; i<module_count(); i++) {
+    int state;
+
+    module_call_state(i, state);
+
+    out.print(FPSTR(name));
+    out.print(F("{module=\""));
+    out.print(module_name(i));
+    out.print(F("\"} "));
+    out.print((state == MODULE_STATE_ACTIVE) ? 1 : 0);
+    out.print('\n');
+  }
+}
+
+bool metrics_render(HTTPServer &server, int step) {
+  uint32_t published, failed;
+
+  // one group of families per step, the last one returns false
+  if (step == 0) {
+    telemetry_stats(published, failed);
+
+    print_counter(server, PSTR("genesys_main_loops_total"),
+      loop_count);
+    print_counter(server, PSTR("genesys_net_rx_bytes_total"),
+      rx_bytes);
+    print_counter(server, PSTR("genesys_net_tx_bytes_total"),
+      tx_bytes);
+    print_counter(server, PSTR("genesys_flash_writes_total"),
+      flash_writes);
+    print_counter(server, PSTR("genesys_mqtt_publish_total"),
+      published);
+    print_counter(server, PSTR("genesys_mqtt_publish_failures_total"),
+      failed);
+  } else if (step == 1) {
+    print_routes(server);
+  } else if (step == 2) {
+    umm_info(NULL, 0);
+
+    print_gauge(server, PSTR("genesys_uptime_seconds"),
+      millis() / 1000);
+    print_gauge(server, PSTR("genesys_heap_free_bytes"),
+      system_free_heap());
+    print_gauge(server, PSTR("genesys_heap_max_block_bytes"),
+      ummHeapInfo.maxFreeContiguousBlocks * HEAP_BLOCK_SIZE);
+    print_gauge(server, PSTR("genesys_stack_free_bytes"),
+      system_free_stack());
+    print_gauge(server, PSTR("genesys_wifi_rssi_dbm"),
+      net_rssi() - 100);
+    print_gauge(server, PSTR("genesys_http_connections"),
+      server.connections());
+  } else if (step == 3) {
+    print_modules(server);
+  } else if (step == 4) {
+    print_histogram(server, PSTR("genesys_http_request_duration_seconds"),
+      server.latency());
+  } else {
+    print_histogram(server, PSTR("genesys_main_loop_duration_seconds"),
+      loop_time);
+
+    return (false);
+  }
+
+  return (true);
+}
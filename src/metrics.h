@@ -0,0 +1,43 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <Arduino.h>
+
+#define METRICS_BUCKETS 10
+
+class HTTPServer;
+
+// latency histogram, the bucket bounds are fixed (see metrics.cpp)
+struct Histogram {
+  uint32_t count[METRICS_BUCKETS + 1]; // the last bucket is +Inf
+  uint64_t sum;                        // microseconds
+};
+
+void metrics_observe(Histogram &h, uint32_t us);
+
+void metrics_poll(void);
+
+// streams the metrics in the Prometheus text format, a few families
+// per step. returns true if there is more to render in the next step
+bool metrics_render(HTTPServer &server, int step);
+
+#endif // _METRICS_H_
@@ -35,11 +35,43 @@ extern "C" void esp_yield();
 #include "system.h"
 #include "module.h"
 #include "config.h"
+#include "cache.h"
+#include "duty.h"
+#include "util.h"
 #include "log.h"
 
 #include "net.h"
 
-static String wifi_list;
+// give up on a directed connect after that long and do a full one (ms)
+#define NET_FAST_TIMEOUT 3000
+
+// also reuse the last DHCP lease, only safe with long lease times
+//#define NET_REUSE_LEASE
+
+// the AP of the last connection, so the next boot can go straight to
+// its channel instead of scanning all of them
+struct NetFastConnect {
+  uint32_t crc;        // over the rest of the struct
+  uint32_t ssid;       // CRC of the SSID it belongs to
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t netmask;
+  uint32_t dns;
+};
+
+static bool fast_connect_pending = false;
+static uint32_t fast_connect_ms  = 0;
+
+// result of the last scan, one entry per SSID, strongest first
+static WiFiNetwork wifi_list[NET_WIFI_MAX];
+static uint8_t wifi_list_count = 0;
+
+static bool wifi_scan_running = false;
+static bool wifi_scan_done    = false;
+static uint32_t wifi_scan_ms  = 0;
 
 static bool wifi_is_connected = false;
 static bool wifi_is_enabled   = false;
@@ -52,26 +84,200 @@ static uint8_t watchdog_lost_pings = 0;
 
 static DNSServer *dns = NULL;
 
-static bool scan_wifi(void) {
-  log_print(F("WIFI: scanning for accesspoints ..."));
+static void scan_store(int i, WiFiNetwork &net) {
+  String ssid = WiFi.SSID(i);
+
+  snprintf(net.ssid, sizeof (net.ssid), "%s", ssid.c_str());
+  memcpy(net.bssid, WiFi.BSSID(i), sizeof (net.bssid));
+
+  net.rssi    = WiFi.RSSI(i);
+  net.channel = WiFi.channel(i);
+  net.auth    = WiFi.encryptionType(i);
+}
 
-  int n = net_scan_wifi();
+static void scan_complete(int n) {
+  wifi_scan_running = false;
+  wifi_list_count = 0;
 
   if (n < 0) {
     log_print(F("WIFI: error while scanning for accesspoints"));
 
-    return (false);
-  } else {
-    if (n == 0) {
-      log_print(F("WIFI: no accesspoints found"));
-    } else {
-      log_print(F("WIFI: found %i unique SSID%s"), n, (n>1)?"s":"");
+    return;
+  }
+
+  for (int i=0; i<n; i++) {
+    String ssid = WiFi.SSID(i);
+    int8_t rssi = WiFi.RSSI(i);
+    int slot = wifi_list_count;
+
+    // keep only the strongest AP of every SSID
+    for (int j=0; j<wifi_list_count; j++) {
+      if (ssid == wifi_list[j].ssid) slot = j;
+    }
+
+    if (slot == NET_WIFI_MAX) {
+      // list is full, replace the weakest entry
+      slot = 0;
+
+      for (int j=1; j<wifi_list_count; j++) {
+        if (wifi_list[j].rssi < wifi_list[slot].rssi) slot = j;
+      }
+    }
+
+    if ((slot < wifi_list_count) && (rssi <= wifi_list[slot].rssi)) continue;
+
+    if (slot == wifi_list_count) wifi_list_count++;
+
+    scan_store(i, wifi_list[slot]);
+  }
+
+  WiFi.scanDelete();
+
+  // sort networks by RSSI
+  for (int i=1; i<wifi_list_count; i++) {
+    WiFiNetwork net = wifi_list[i];
+    int j = i;
+
+    for (; (j > 0) && (wifi_list[j - 1].rssi < net.rssi); j--) {
+      wifi_list[j] = wifi_list[j - 1];
     }
+
+    wifi_list[j] = net;
+  }
+
+  wifi_scan_done = true;
+  wifi_scan_ms = millis();
+
+  cache_invalidate(CACHE_TAG_WIFI);
+
+  if (wifi_list_count == 0) {
+    log_print(F("WIFI: no accesspoints found"));
+  } else {
+    log_print(F("WIFI: found %i unique SSID%s"),
+      wifi_list_count, (wifi_list_count > 1) ? "s" : ""
+    );
+  }
+}
+
+static void poll_scan(void) {
+  if (wifi_scan_running) {
+    int n = WiFi.scanComplete();
+
+    if (n != WIFI_SCAN_RUNNING) scan_complete(n);
+  }
+}
+
+static uint32_t fast_connect_crc(const NetFastConnect &fc) {
+  return (crc32_update(0, &fc.ssid, sizeof (fc) - sizeof (fc.crc)));
+}
+
+static uint32_t ssid_crc(const char *ssid) {
+  return (crc32_update(0, ssid, strlen(ssid)));
+}
+
+static bool fast_connect_load(NetFastConnect &fc, const char *ssid) {
+  system_rtc_mem_read(RTC_MEM_NET, &fc, sizeof (fc));
+
+  if (fc.crc != fast_connect_crc(fc)) return (false);
+  if (fc.ssid != ssid_crc(ssid)) return (false);
+
+  return ((fc.channel >= 1) && (fc.channel <= 14));
+}
+
+static void fast_connect_save(void) {
+  NetFastConnect fc, old;
+
+  memset(&fc, 0, sizeof (fc));
+
+  fc.ssid    = ssid_crc(WiFi.SSID().c_str());
+  fc.channel = WiFi.channel();
+  fc.ip      = WiFi.localIP();
+  fc.gateway = WiFi.gatewayIP();
+  fc.netmask = WiFi.subnetMask();
+  fc.dns     = WiFi.dnsIP(0);
+
+  memcpy(fc.bssid, WiFi.BSSID(), sizeof (fc.bssid));
+
+  fc.crc = fast_connect_crc(fc);
+
+  system_rtc_mem_read(RTC_MEM_NET, &old, sizeof (old));
+
+  if (memcmp(&fc, &old, sizeof (fc))) {
+    system_rtc_mem_write(RTC_MEM_NET, &fc, sizeof (fc));
   }
+}
+
+static void fast_connect_clear(void) {
+  NetFastConnect fc;
+
+  memset(&fc, 0, sizeof (fc));
+
+  system_rtc_mem_write(RTC_MEM_NET, &fc, sizeof (fc));
+}
+
+// connect to the AP of the last connection without scanning
+static bool fast_connect(const String &ssid, const String &pass, bool dhcp) {
+  NetFastConnect fc;
+
+  if (!fast_connect_load(fc, ssid.c_str())) return (false);
+
+  log_print(F("WIFI: fast connect to %02x:%02x:%02x:%02x:%02x:%02x on channel %i"),
+    fc.bssid[0], fc.bssid[1], fc.bssid[2],
+    fc.bssid[3], fc.bssid[4], fc.bssid[5], fc.channel
+  );
+
+#ifdef NET_REUSE_LEASE
+  if (dhcp && fc.ip) {
+    WiFi.config(IPAddress(fc.ip), IPAddress(fc.gateway),
+                IPAddress(fc.netmask), IPAddress(fc.dns));
+  }
+#endif
+
+  WiFi.begin(ssid.c_str(), pass.c_str(), fc.channel, fc.bssid);
+
+  fast_connect_pending = true;
+  fast_connect_ms = millis();
 
   return (true);
 }
 
+static void poll_fast_connect(void) {
+  String ssid, pass;
+  bool dhcp;
+
+  if (!fast_connect_pending) return;
+
+  if (wifi_is_connected) {
+    log_print(F("WIFI: fast connect took %u ms"), millis() - fast_connect_ms);
+
+    fast_connect_pending = false;
+
+    return;
+  }
+
+  if ((millis() - fast_connect_ms) < NET_FAST_TIMEOUT) return;
+
+  log_print(F("WIFI: fast connect failed, scanning for AP"));
+
+  fast_connect_pending = false;
+  fast_connect_clear();
+
+  config_init();
+  config_get(F("wifi_ssid"), ssid);
+  config_get(F("wifi_pass"), pass);
+  dhcp = !config->ip_static;
+  config_fini();
+
+#ifdef NET_REUSE_LEASE
+  // back to DHCP
+  if (dhcp) wifi_station_dhcpc_start();
+#endif
+
+  WiFi.begin(ssid.c_str(), pass.c_str());
+
+  net_scan_wifi();
+}
+
 static void default_event_handler(WiFiEvent_t event) {
   if (event == WIFI_EVENT_SOFTAPMODE_STACONNECTED) {
     log_print(F("WIFI: client connected to soft AP"));
@@ -100,6 +306,9 @@ static void default_event_handler(WiFiEvent_t event) {
       log_print(F("WIFI: STA connected, local IP: %s"), net_ip().c_str());
       wifi_is_connected = true;
 
+      // remember the AP for the next boot
+      fast_connect_save();
+
       // activate watchdog
       watchdog_enabled = (watchdog_timeout != 0);
     }
@@ -243,8 +452,9 @@ bool net_init(void) {
 
   if (wifi_is_enabled) return (false);
 
-  // store WiFi config in SDK flash area
-  WiFi.persistent(true);
+  // SSID and password come from our own config on every boot, keeping
+  // a copy in the SDK flash area only costs sector writes
+  WiFi.persistent(false);
 
   // delete old config, disable STA and AP
   WiFi.disconnect(true);       // true = disable STA mode
@@ -262,15 +472,12 @@ bool net_init(void) {
   // register default event handler
   WiFi.onEvent(default_event_handler);
 
-  // make sure EEPROM is mounted
+  // make sure the config is loaded
   config_init();
 
   // store watchdog timeout
   watchdog_timeout = config->wifi_watchdog;
 
-  // get a list of available SSIDs
-  scan_wifi();
-
   // start wifi (enabling STA mode)
   if (bootup && !config->wifi_enabled) {
     log_print(F("WIFI: STA is disabled in config"));
@@ -301,7 +508,9 @@ bool net_init(void) {
       config_get(F("wifi_ssid"), ssid);
       config_get(F("wifi_pass"), pass);
 
-      WiFi.begin(ssid.c_str(), pass.c_str());
+      if (!fast_connect(ssid, pass, !config->ip_static)) {
+        WiFi.begin(ssid.c_str(), pass.c_str());
+      }
 
       log_print(F("WIFI: waiting for STA to connect (%s) ..."),
         config->wifi_ssid
@@ -311,8 +520,14 @@ bool net_init(void) {
     }
   }
 
+  // get a list of available SSIDs, the result arrives in net_poll(). the
+  // scan would hold up a directed connect, so it waits for the fallback.
+  if (!fast_connect_pending && !duty_cycling()) net_scan_wifi();
+
   // start local AP
-  if (bootup && !config->ap_enabled) {
+  if (duty_cycling()) {
+    log_print(F("WIFI: no AP while duty cycling"));
+  } else if (bootup && !config->ap_enabled) {
     log_print(F("WIFI: AP disabled in config"));
   } else {
     IPAddress addr(config->ap_addr);
@@ -330,7 +545,7 @@ bool net_init(void) {
     }
   }
 
-  if (!dns && !wifi_is_enabled) {
+  if (!dns && !wifi_is_enabled && !duty_cycling()) {
     IPAddress ap_addr(config->ap_addr);
 
     dns = new DNSServer();
@@ -361,6 +576,8 @@ bool net_fini(void) {
   wifi_is_enabled   = false;
   wifi_is_connected = false;
 
+  fast_connect_pending = false;
+
   watchdog_lost_pings = 0;
   watchdog_timeout    = 0;
   watchdog_enabled    = false;
@@ -369,6 +586,8 @@ bool net_fini(void) {
 }
 
 void net_poll(void) {
+  poll_fast_connect();
+  poll_scan();
   poll_watchdog_sta();
   poll_watchdog_ping();
   poll_dns();
@@ -415,64 +634,38 @@ void net_wakeup(void) {
   WiFi.forceSleepWake();
 }
 
-int net_scan_wifi(void) {
-  int unique = 0, n = WiFi.scanNetworks();
-
-  wifi_list = "";
-
-  if (n <= 0) return (n);
-
-  int indices[n];
+bool net_scan_wifi(void) {
+  if (wifi_scan_running) return (true);
 
-  // prepare a list of indices
-  for (int i=0; i<n; i++) {
-    indices[i] = i;
-  }
+  if (WiFi.scanNetworks(true) != WIFI_SCAN_RUNNING) {
+    log_print(F("WIFI: error while scanning for accesspoints"));
 
-  // sort networks by RSSI
-  for (int i=0; i<n; i++) {
-    for (int j=i+1; j<n; j++) {
-      if (WiFi.RSSI(indices[j]) > WiFi.RSSI(indices[i])) {
-        indices[i] ^= indices[j] ^= indices[i] ^= indices[j];
-      }
-    }
+    return (false);
   }
 
-  // mark duplicates
-  for (int i=0; i<n; i++) {
-    if (indices[i] == -1) continue;
+  log_print(F("WIFI: scanning for accesspoints ..."));
 
-    String ssid = WiFi.SSID(indices[i]);
+  wifi_scan_running = true;
 
-    for (int j=i+1; j<n; j++) {
-      if (ssid == WiFi.SSID(indices[j])){
-        indices[j] = -1; // set duplicate AP to index -1
-      }
-    }
-  }
- 
-  // store unique APs in list, strongest first
-  for (int i=0; i<n; i++) {
-    // skip removed indices
-    if (indices[i] == -1) continue;
+  return (true);
+}
 
-    wifi_list += WiFi.SSID(indices[i]);
-    wifi_list += '\t';
-    wifi_list += (int)WiFi.RSSI(indices[i]) + 100;
-    wifi_list += '\b';
-    wifi_list += (int)WiFi.encryptionType(indices[i]);
-    wifi_list += '\r';
+bool net_scan_running(void) {
+  return (wifi_scan_running);
+}
 
-    unique++;
-  }
+uint32_t net_scan_age(void) {
+  if (!wifi_scan_done) return (UINT32_MAX);
 
-  WiFi.scanDelete();
+  return (millis() - wifi_scan_ms);
+}
 
-  return (unique);
+int net_wifi_count(void) {
+  return (wifi_list_count);
 }
 
-const String &net_list_wifi(void) {
-  return (wifi_list);
+const WiFiNetwork &net_wifi_network(int i) {
+  return (wifi_list[i]);
 }
 
 static void wifi_dns_cb(const char *name, ip_addr_t *ipaddr, void *arg) {
@@ -23,6 +23,16 @@
 #include <ESP8266WiFi.h>
 #include <Arduino.h>
 
+#define NET_WIFI_MAX 16
+
+struct WiFiNetwork {
+  char ssid[33];
+  uint8_t bssid[6];
+  int8_t rssi;         // dBm
+  uint8_t channel;
+  uint8_t auth;        // ENC_TYPE_*
+};
+
 int net_state(void);
 bool net_init(void);
 bool net_fini(void);
@@ -33,8 +43,13 @@ bool net_enabled(void);
 
 bool net_ping(const char *dest, int count = 3);
 
-int net_scan_wifi(void);
-const String &net_list_wifi(void);
+// scanning runs in the background, the result is kept until the next scan
+bool net_scan_wifi(void);
+bool net_scan_running(void);
+uint32_t net_scan_age(void);
+
+int net_wifi_count(void);
+const WiFiNetwork &net_wifi_network(int i);
 
 void net_sleep(uint32_t us = 0);
 void net_wakeup(void);
@@ -0,0 +1,458 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#include <StreamString.h>
+#include <Updater.h>
+
+#include "system.h"
+#include "config.h"
+#include "log.h"
+
+#include "ota.h"
+
+// a packed image starts with a 24 byte header (magic, image size and
+// MD5 of the image) followed by LZSS data with a 4096 byte window. each
+// flag byte describes the following eight items, LSB first: a set bit
+// is a literal byte, a cleared bit a back reference of two bytes, the
+// low eight bits of (distance - 1) and then the upper four bits of it
+// in the high nibble plus (length - 3) in the low nibble. anything not
+// starting with the magic is written as it is.
+//
+// a delta image has the same header and is packed the same way, but
+// the decompressed stream is a list of operations that rebuild the
+// new image from the running one. each is an opcode followed by its
+// uint32 (little endian) arguments:
+//
+//   SOURCE size          the size of the image the delta was made for
+//   COPY   offset len    copy len bytes of the running image
+//   ADD    offset len    len bytes follow, each is added to the byte
+//                        of the running image at the same position
+//   DATA   len           len bytes follow, taken as they are
+
+#define OTA_MAGIC_PACKED "GNLZ"
+#define OTA_MAGIC_DELTA  "GNDP"
+#define OTA_MAGIC_LEN    4
+#define OTA_HEADER_LEN   24
+#define OTA_WINDOW     4096
+#define OTA_MIN_MATCH  3
+#define OTA_CHUNK      256
+#define OTA_CACHE      32
+
+#define OTA_OP_SOURCE  0
+#define OTA_OP_COPY    1
+#define OTA_OP_ADD     2
+#define OTA_OP_DATA    3
+#define OTA_OP_NONE    0xff
+
+struct OTA_PrivateData {
+  uint32_t space;      // free sketch space
+  uint32_t size;       // image size, 0 if unknown (raw image)
+  uint32_t written;
+
+  bool started;        // Update.begin() was called
+  bool packed;
+  bool delta;
+  char md5[33];
+
+  // the header is collected until it is known what we receive
+  uint8_t head[OTA_HEADER_LEN];
+  uint8_t head_len;
+
+  // decoder state
+  uint8_t *window;
+  uint16_t pos;
+  uint16_t flags;      // 0x100 marks the end of a flag byte
+  uint8_t ref;
+  bool ref_pending;
+
+  uint8_t buf[OTA_CHUNK];
+  uint16_t len;
+
+  // delta state
+  uint8_t op;
+  uint8_t args[8];
+  uint8_t arg_len;
+  uint32_t offset;     // in the running image
+  uint32_t remaining;  // bytes left in the current operation
+
+  // flash reads need to be aligned
+  uint32_t cache[OTA_CACHE / 4];
+  uint32_t cache_addr;
+};
+
+static OTA_PrivateData *p = NULL;
+
+static bool failed = false;
+
+static void update_error(void) {
+  StreamString out;
+  String err;
+
+  Update.printError(out);
+  err = out.readString();
+  err.replace("\r", "");
+  err.replace("\n", "");
+
+  log_print(err.c_str());
+
+  failed = true;
+}
+
+static void fail(const __FlashStringHelper *msg) {
+  log_print(msg);
+
+  failed = true;
+}
+
+static bool start(uint32_t size) {
+  if (size > p->space) {
+    log_print(F("OTA:  image does not fit (%u > %u bytes)"), size, p->space);
+
+    failed = true;
+
+    return (false);
+  }
+
+  if (!Update.begin(size)) {
+    update_error();
+
+    return (false);
+  }
+
+  if (p->md5[0]) Update.setMD5(p->md5);
+
+  p->started = true;
+
+  return (true);
+}
+
+static void flush(void) {
+  if (p->len == 0) return;
+
+  if (Update.write(p->buf, p->len) != p->len) update_error();
+
+  p->written += p->len;
+  p->len = 0;
+}
+
+static void put(uint8_t c) {
+  p->buf[p->len++] = c;
+
+  if (p->len == OTA_CHUNK) flush();
+}
+
+static uint8_t source(uint32_t addr) {
+  uint32_t base = addr & ~(OTA_CACHE - 1);
+
+  if (base != p->cache_addr) {
+    ESP.flashRead(base, p->cache, OTA_CACHE);
+    p->cache_addr = base;
+  }
+
+  return (((uint8_t *)p->cache)[addr - base]);
+}
+
+static uint8_t arg_count(uint8_t op) {
+  if ((op == OTA_OP_COPY) || (op == OTA_OP_ADD)) return (8);
+
+  return (4);
+}
+
+static void operation(void) {
+  uint32_t sketch = system_sketch_size();
+  uint32_t arg[2];
+
+  memcpy(arg, p->args, sizeof (arg));
+
+  if (p->op == OTA_OP_SOURCE) {
+    if (arg[0] != sketch) {
+      fail(F("OTA:  delta does not match the running firmware"));
+    }
+
+    p->op = OTA_OP_NONE;
+
+    return;
+  }
+
+  if (p->op == OTA_OP_DATA) {
+    p->remaining = arg[0];
+  } else {
+    p->offset    = arg[0];
+    p->remaining = arg[1];
+
+    if ((p->offset > sketch) || (p->remaining > (sketch - p->offset))) {
+      fail(F("OTA:  delta refers beyond the running firmware"));
+
+      return;
+    }
+  }
+
+  if (p->op == OTA_OP_COPY) {
+    while (p->remaining && !failed) {
+      put(source(p->offset++));
+      p->remaining--;
+
+      // erasing sectors takes a while, keep the watchdog happy
+      if ((p->offset % 4096) == 0) system_yield();
+    }
+  }
+
+  if (p->remaining == 0) p->op = OTA_OP_NONE;
+}
+
+static void patch(uint8_t c) {
+  if (p->op == OTA_OP_NONE) {
+    if (c > OTA_OP_DATA) {
+      fail(F("OTA:  corrupt delta image"));
+
+      return;
+    }
+
+    p->op = c;
+    p->arg_len = 0;
+    memset(p->args, 0, sizeof (p->args));
+  } else if (p->arg_len < arg_count(p->op)) {
+    p->args[p->arg_len++] = c;
+
+    if (p->arg_len == arg_count(p->op)) operation();
+  } else {
+    if (p->op == OTA_OP_ADD) c += source(p->offset++);
+
+    put(c);
+
+    if (--p->remaining == 0) p->op = OTA_OP_NONE;
+  }
+}
+
+static void emit(uint8_t c) {
+  p->window[p->pos++ & (OTA_WINDOW - 1)] = c;
+
+  if (p->delta) {
+    patch(c);
+  } else {
+    put(c);
+  }
+}
+
+static void decode(const uint8_t *data, size_t len) {
+  while (len-- && !failed) {
+    uint8_t c = *data++;
+
+    if (p->flags <= 1) {
+      p->flags = c | 0x100;
+    } else if (p->flags & 1) {
+      emit(c);
+      p->flags >>= 1;
+    } else if (!p->ref_pending) {
+      p->ref = c;
+      p->ref_pending = true;
+    } else {
+      uint16_t dist = (p->ref | ((c & 0xf0) << 4)) + 1;
+      int n = (c & 0x0f) + OTA_MIN_MATCH;
+      uint16_t from = p->pos - dist;
+
+      while (n--) emit(p->window[from++ & (OTA_WINDOW - 1)]);
+
+      p->ref_pending = false;
+      p->flags >>= 1;
+    }
+  }
+}
+
+static void md5_hex(char *str, const uint8_t *data, int len) {
+  for (int i=0; i<len; i++) {
+    sprintf_P(str + 2 * i, PSTR("%02x"), data[i]);
+  }
+}
+
+static bool is_magic(const char *magic, uint8_t len) {
+  if (len > OTA_MAGIC_LEN) len = OTA_MAGIC_LEN;
+
+  return (memcmp(p->head, magic, len) == 0);
+}
+
+// decide from the first bytes whether the image is packed, delta or raw
+static size_t header(const uint8_t *data, size_t len) {
+  size_t used = 0;
+
+  while ((used < len) && (p->head_len < OTA_HEADER_LEN)) {
+    p->head[p->head_len] = data[used];
+
+    if (!is_magic(OTA_MAGIC_PACKED, p->head_len + 1) &&
+        !is_magic(OTA_MAGIC_DELTA,  p->head_len + 1)) break;
+
+    p->head_len++;
+    used++;
+  }
+
+  if (p->head_len == OTA_HEADER_LEN) {
+    memcpy(&p->size, p->head + OTA_MAGIC_LEN, sizeof (p->size));
+    md5_hex(p->md5, p->head + OTA_MAGIC_LEN + sizeof (p->size), 16);
+
+    p->delta = is_magic(OTA_MAGIC_DELTA, OTA_MAGIC_LEN);
+
+    if (p->delta) {
+      log_print(F("OTA:  receiving delta image (%u bytes)"), p->size);
+    } else {
+      log_print(F("OTA:  receiving packed image (%u bytes)"), p->size);
+    }
+
+    p->window = (uint8_t *)malloc(OTA_WINDOW);
+    p->packed = true;
+
+    if (!p->window) {
+      fail(F("OTA:  out of memory"));
+    } else {
+      start(p->size);
+    }
+  } else if (used < len) {
+    // not our magic, so this is a raw image of unknown size
+    log_print(F("OTA:  receiving raw image"));
+
+    if (start(p->space)) {
+      if (Update.write(p->head, p->head_len) != p->head_len) update_error();
+
+      p->written += p->head_len;
+    }
+  }
+
+  return (used);
+}
+
+bool ota_begin(uint32_t space) {
+  // one image at a time, whoever wants to start over aborts first
+  if (p) return (false);
+
+  // the image ends where the config journal begins
+  if (!config_reserve(true)) return (false);
+
+  p = (OTA_PrivateData *)malloc(sizeof (OTA_PrivateData));
+  memset(p, 0, sizeof (OTA_PrivateData));
+
+  p->space = space;
+
+  p->op = OTA_OP_NONE;
+  p->cache_addr = UINT32_MAX;
+
+  failed = false;
+
+  return (true);
+}
+
+// expected MD5 of a raw image, packed images bring their own
+bool ota_md5(const String &md5) {
+  if (!p || p->started || (md5.length() != 32)) return (false);
+
+  strcpy(p->md5, md5.c_str());
+
+  return (true);
+}
+
+size_t ota_write(const uint8_t *data, size_t len) {
+  size_t used = 0;
+
+  if (!p || failed) return (0);
+
+  if (!p->started && !p->packed) {
+    used = header(data, len);
+  }
+
+  if (failed || !p->started) return (len);
+
+  if (p->packed) {
+    decode(data + used, len - used);
+  } else if (used < len) {
+    if (Update.write((uint8_t *)data + used, len - used) != len - used) {
+      update_error();
+    }
+
+    p->written += len - used;
+  }
+
+  return (failed ? 0 : len);
+}
+
+bool ota_end(void) {
+  bool ok = false;
+
+  if (!p) return (false);
+
+  if (p->packed && !failed) flush();
+
+  if (!p->started) {
+    if (!failed) fail(F("OTA:  no image received"));
+  } else if (failed) {
+    Update.end(false);
+  } else if (p->packed && (p->written != p->size)) {
+    log_print(F("OTA:  image incomplete (%u of %u bytes)"), p->written, p->size);
+
+    failed = true;
+
+    Update.end(false);
+  } else if (!Update.end(!p->packed)) {
+    // a raw image of unknown size ends where the data ends
+    update_error();
+  } else {
+    log_print(F("OTA:  image verified (%u bytes)"), p->written);
+
+    ok = true;
+  }
+
+  // a verified image stays where it is until the reboot
+  if (!ok) config_reserve(false);
+
+  free(p->window);
+  free(p);
+  p = NULL;
+
+  return (ok);
+}
+
+void ota_abort(void) {
+  if (!p) return;
+
+  if (p->started) Update.end(false);
+
+  failed = true;
+
+  config_reserve(false);
+
+  free(p->window);
+  free(p);
+  p = NULL;
+}
+
+bool ota_active(void) {
+  return (p != NULL);
+}
+
+bool ota_failed(void) {
+  return (failed || Update.hasError());
+}
+
+int ota_progress(void) {
+  uint32_t size;
+
+  if (!p) return (0);
+
+  // for raw images the running firmware is the best guess
+  size = (p->size) ? p->size : system_sketch_size();
+
+  return (100 * (uint64_t)p->written / size);
+}
@@ -0,0 +1,43 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#ifndef _OTA_H_
+#define _OTA_H_
+
+#include <Arduino.h>
+
+// firmware sink shared by the push (/update) and pull (update_poll)
+// paths. accepts raw images as well as packed images and deltas against
+// the running firmware made by ota.pl, which are decompressed on the fly
+// and verified before they are committed.
+
+// false while another image is being received
+bool ota_begin(uint32_t space);
+bool ota_md5(const String &md5);
+
+size_t ota_write(const uint8_t *data, size_t len);
+
+bool ota_end(void);
+void ota_abort(void);
+
+bool ota_active(void);
+bool ota_failed(void);
+int ota_progress(void);
+
+#endif // _OTA_H_
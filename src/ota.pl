@@ -0,0 +1,210 @@
+#!/usr/bin/perl
+#
+# This file is part of Genesys.
+#
+# Genesys is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Genesys is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+#
+# Packs a firmware image for compressed OTA updates, or builds a delta
+# against the image that is running on the device.
+#
+# usage: ota.pl <image.bin> > image.bin.lz
+#        ota.pl <image.bin> <running.bin> > image.bin.delta
+#
+# The output is a 24 byte header (magic "GNLZ" or "GNDP", image size as
+# uint32 little endian, MD5 of the image) followed by the LZSS compressed
+# image or delta operations with a 4096 byte window (see ota.cpp for the
+# format).
+
+use strict;
+use warnings;
+
+use Digest::MD5 qw(md5);
+
+use constant WINDOW    => 4096;
+use constant MIN_MATCH => 3;
+use constant MAX_MATCH => 15 + MIN_MATCH;
+use constant MAX_CHAIN => 32;
+
+use constant OP_SOURCE => 0;
+use constant OP_COPY   => 1;
+use constant OP_ADD    => 2;
+use constant OP_DATA   => 3;
+
+use constant BLOCK     => 8;
+use constant MIN_COPY  => 16;
+
+sub compress {
+  my ($src) = @_;
+  my ($out, $flags, $items, $bit) = ('', 0, '', 0);
+  my $size = length($src);
+  my %chain;
+  my $pos = 0;
+
+  while ($pos < $size) {
+    my ($best_len, $best_dist) = (0, 0);
+    my $key = substr($src, $pos, MIN_MATCH);
+    my $list = $chain{$key} //= [];
+
+    # walk the most recent candidates with the same three byte prefix
+    for (my $i=$#$list; $i>=0 && $i>$#$list-MAX_CHAIN; $i--) {
+      my $dist = $pos - $list->[$i];
+
+      last if ($dist > WINDOW);
+
+      my $diff = substr($src, $list->[$i], MAX_MATCH) ^ substr($src, $pos, MAX_MATCH);
+      my $len = ($diff =~ /^(\0*)/) ? length($1) : 0;
+
+      $len = $size - $pos if ($len > $size - $pos);
+
+      ($best_len, $best_dist) = ($len, $dist) if ($len > $best_len);
+
+      last if ($best_len == MAX_MATCH);
+    }
+
+    my $step = ($best_len >= MIN_MATCH) ? $best_len : 1;
+
+    if ($best_len >= MIN_MATCH) {
+      # flag bit 0: reference (12 bit distance - 1, 4 bit length - MIN_MATCH)
+      my $d = $best_dist - 1;
+
+      $items .= pack('CC', $d & 0xff, (($d >> 8) << 4) | ($best_len - MIN_MATCH));
+    } else {
+      # flag bit 1: literal
+      $flags |= (1 << $bit);
+      $items .= substr($src, $pos, 1);
+    }
+
+    for (my $i=0; $i<$step; $i++, $pos++) {
+      my $list = $chain{substr($src, $pos, MIN_MATCH)} //= [];
+
+      push(@$list, $pos);
+      splice(@$list, 0, @$list - MAX_CHAIN) if (@$list > 2 * MAX_CHAIN);
+    }
+
+    if (++$bit == 8) {
+      $out .= pack('C', $flags) . $items;
+      ($flags, $items, $bit) = (0, '', 0);
+    }
+  }
+
+  $out .= pack('C', $flags) . $items if ($bit);
+
+  return $out;
+}
+
+sub match_length {
+  my ($old, $o, $new, $n) = @_;
+  my $len = 0;
+
+  while (1) {
+    my $diff = substr($old, $o + $len, 256) ^ substr($new, $n + $len, 256);
+    my $same = ($diff =~ /^(\0*)/) ? length($1) : 0;
+
+    $len += $same;
+
+    return $len if ($same < 256);
+  }
+}
+
+# unmatched bytes become an ADD against the running image at the same
+# relative position if that leaves mostly zeros (shifted addresses in
+# otherwise unchanged code), else plain DATA
+sub literal {
+  my ($old, $o, $data) = @_;
+  my $len = length($data);
+
+  return '' unless ($len);
+
+  if ($o + $len <= length($old)) {
+    my @a = unpack('C*', $data);
+    my @b = unpack('C*', substr($old, $o, $len));
+    my $diff = pack('C*', map { ($a[$_] - $b[$_]) & 0xff } 0 .. $#a);
+
+    if (($diff =~ tr/\0//) * 2 > $len) {
+      return pack('CVV', OP_ADD, $o, $len) . $diff;
+    }
+  }
+
+  return pack('CV', OP_DATA, $len) . $data;
+}
+
+sub delta {
+  my ($new, $old) = @_;
+  my $ops = pack('CV', OP_SOURCE, length($old));
+  my ($pos, $lit, $next) = (0, 0, 0);
+  my %index;
+
+  for (my $i=length($old)-BLOCK; $i>=0; $i--) {
+    $index{substr($old, $i, BLOCK)} = $i;
+  }
+
+  while ($pos < length($new)) {
+    my ($best_len, $best_off) = (0, 0);
+
+    # try to continue where the last copy ended first
+    foreach my $o ($next + $pos - $lit, $index{substr($new, $pos, BLOCK)}) {
+      next unless (defined($o) && ($o < length($old)));
+
+      my $len = match_length($old, $o, $new, $pos);
+
+      $len = length($old) - $o if ($len > length($old) - $o);
+      $len = length($new) - $pos if ($len > length($new) - $pos);
+
+      ($best_len, $best_off) = ($len, $o) if ($len > $best_len);
+    }
+
+    if ($best_len >= MIN_COPY) {
+      $ops .= literal($old, $next, substr($new, $lit, $pos - $lit));
+      $ops .= pack('CVV', OP_COPY, $best_off, $best_len);
+
+      $pos += $best_len;
+      ($lit, $next) = ($pos, $best_off + $best_len);
+    } else {
+      $pos++;
+    }
+  }
+
+  $ops .= literal($old, $next, substr($new, $lit, $pos - $lit));
+
+  return $ops;
+}
+
+sub slurp {
+  my ($file) = @_;
+
+  open(my $fh, '<:raw', $file) or die "$file: $!\n";
+  my $data = do { local $/; <$fh> };
+  close($fh);
+
+  return $data;
+}
+
+die "usage: ota.pl <image.bin> [<running.bin>]\n" unless (@ARGV == 1 || @ARGV == 2);
+
+my $image = slurp($ARGV[0]);
+my ($magic, $lz);
+
+if (@ARGV == 2) {
+  ($magic, $lz) = ('GNDP', compress(delta($image, slurp($ARGV[1]))));
+} else {
+  ($magic, $lz) = ('GNLZ', compress($image));
+}
+
+binmode(STDOUT);
+print $magic, pack('V', length($image)), md5($image), $lz;
+
+printf STDERR "  OTA %s: %d bytes -> %d bytes\n",
+  (@ARGV == 2) ? 'delta' : 'image', length($image), length($lz) + 24;
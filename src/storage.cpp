@@ -29,92 +29,491 @@
 
 #include "storage.h"
 
-struct CSV_PrivateData {
+#define STORAGE_MAGIC      0x42535447 // "GTSB"
+#define STORAGE_BLOCK_SIZE 256        // bytes of compressed samples
+#define STORAGE_BLOCK_SPAN 3600       // s, at most lost on a power loss
+#define STORAGE_SAMPLE_MAX 100        // bits of the worst case sample
+
+// The data file is a sequence of blocks, each a StorageBlock followed by
+// the samples packed into a bit stream. The first sample of a block is
+// stored as is, all others as the difference to the one before: the
+// time as delta of the delta, the ADC as delta and the temperature as
+// XOR of the float bits, like Facebook's Gorilla does it. The index file
+// holds one StorageIndex per block, to find the blocks of a time range.
+
+struct StorageBlock {
+  uint32_t magic;
+  uint32_t min;          // time of the oldest sample
+  uint32_t max;          // time of the newest sample
+  uint16_t count;        // samples in the block
+  uint16_t len;          // bytes following the header
+  uint8_t  mask;         // columns stored, STORAGE_MASK_*
+  uint8_t  reserved;
+  uint16_t crc;          // lower half of the CRC-32 of the samples
+};
+
+struct StorageIndex {
+  uint32_t max;
+  uint32_t offset;       // of the StorageBlock in the data file
+};
+
+struct Sample {
+  uint32_t time;
+  uint16_t adc;
+  float    temp;
+};
+
+// state of the bit stream of one block, used to encode and to decode
+struct Codec {
+  uint8_t *buf;
+  uint32_t pos;          // in bits
+
+  uint32_t time;
+  int32_t  delta;
+  uint16_t adc;
+  uint32_t temp;         // bits of the float
+  uint8_t  lead, trail;  // zero bits around the last XOR
+};
+
+struct STORAGE_PrivateData {
   // settings from config
   uint32_t storage_interval;
   uint32_t storage_mask;
-};
 
-static File f;
+  // block being filled, written to the file when full
+  StorageBlock block;
+  Codec codec;
+  uint8_t buf[STORAGE_BLOCK_SIZE];
 
-static CSV_PrivateData *p = NULL;
+  // blocks in the data file
+  int blocks;
+};
+
+static STORAGE_PrivateData *p = NULL;
 
 enum {
   STORAGE_MASK_ADC  = 1<<0,
   STORAGE_MASK_TEMP = 1<<1,
 };
 
-static void write_header(void) {
-  uint32_t mask = p->storage_mask;
-  String head;
+// the widths a value can be stored with, the prefix selects one
+static const uint8_t time_width[] = { 0, 7, 9, 12, 32 };
+static const uint8_t adc_width[]  = { 0, 4, 8, 17 };
+
+static String file_name(const __FlashStringHelper *ext) {
+  return (system_device_name() + String(ext));
+}
+
+static uint32_t zigzag(int32_t value) {
+  return (((uint32_t)value << 1) ^ (value >> 31));
+}
+
+static int32_t unzigzag(uint32_t value) {
+  return ((value >> 1) ^ -(int32_t)(value & 1));
+}
+
+static uint16_t block_crc(const uint8_t *data, uint16_t len) {
+  return (crc32_update(0, data, len) & 0xFFFF);
+}
 
-  if (!head.reserve(128)) {
-    log_print(F("CSV:  failed to allocate header buffer"));
+static void put_bits(Codec &c, uint32_t value, int n) {
+  while (n--) {
+    if (value & (1UL << n)) c.buf[c.pos >> 3] |= 0x80 >> (c.pos & 7);
+    c.pos++;
   }
+}
+
+static uint32_t get_bits(Codec &c, int n) {
+  uint32_t value = 0;
+
+  while (n--) {
+    value = (value << 1) | ((c.buf[c.pos >> 3] >> (7 - (c.pos & 7))) & 1);
+    c.pos++;
+  }
+
+  return (value);
+}
+
+// a prefix of i one bits (and a zero unless it is the last width)
+// selects width[i], the smallest the value fits into
+static void put_value(Codec &c, uint32_t value, const uint8_t *width, int n) {
+  int i;
+
+  for (i=0; i<n-1; i++) {
+    if (value < (1UL << width[i])) break;
+  }
+
+  put_bits(c, (1UL << i) - 1, i);
+  if (i < n - 1) put_bits(c, 0, 1);
+  put_bits(c, value, width[i]);
+}
 
-  // make header line
-  head += F("timestamp;localtime;");
-  if (mask & STORAGE_MASK_ADC)  head += F("adc;");
-  if (mask & STORAGE_MASK_TEMP) head += F("temp;");
+static uint32_t get_value(Codec &c, const uint8_t *width, int n) {
+  int i = 0;
 
-  // replace the last ';' with '\r' and append '\n'
-  head[head.length() - 1] = '\r'; head += F("\n");
+  while ((i < n - 1) && get_bits(c, 1)) i++;
 
-  if (f) {
-    f.print(head);
-    f.flush();
+  return (get_bits(c, width[i]));
+}
+
+static void put_temp(Codec &c, uint32_t temp) {
+  uint32_t x = temp ^ c.temp;
+  uint8_t lead, trail;
+
+  if (!x) {
+    put_bits(c, 0, 1);
+
+    return;
+  }
+
+  lead  = __builtin_clz(x);
+  trail = __builtin_ctz(x);
+
+  if ((lead >= c.lead) && (trail >= c.trail)) {
+    // fits into the window of the last XOR
+    put_bits(c, 2, 2);
+    put_bits(c, x >> c.trail, 32 - c.lead - c.trail);
   } else {
-    log_print(F("CSV:  cannot write header to file"));
+    put_bits(c, 3, 2);
+    put_bits(c, lead, 5);
+    put_bits(c, 32 - lead - trail - 1, 5);
+    put_bits(c, x >> trail, 32 - lead - trail);
+
+    c.lead  = lead;
+    c.trail = trail;
   }
+
+  c.temp = temp;
 }
 
-static void open_file(void) {
-  if (rootfs) {
-    String file = system_device_name() + String(".csv");
-    bool header = !rootfs->exists(file);
+static void get_temp(Codec &c) {
+  int len;
 
-    f = rootfs->open(file, "a");
+  if (!get_bits(c, 1)) return;
 
-    if (f) {
-      if (header) {
-        log_print(F("CSV:  created storage file '%s'"), file.c_str());
+  if (get_bits(c, 1)) {
+    c.lead  = get_bits(c, 5);
+    c.trail = 32 - c.lead - (get_bits(c, 5) + 1);
+  }
+
+  len = 32 - c.lead - c.trail;
+
+  c.temp ^= get_bits(c, len) << c.trail;
+}
+
+static void encode(Codec &c, const Sample &s, uint8_t mask, bool first) {
+  uint32_t temp;
+
+  memcpy(&temp, &s.temp, sizeof (temp));
 
-        write_header();
-      }
-    } else {
-      log_print(F("CSV:  failed to open file '%s'"), file.c_str());
+  if (first) {
+    put_bits(c, s.time, 32);
+    if (mask & STORAGE_MASK_ADC)  put_bits(c, s.adc,  16);
+    if (mask & STORAGE_MASK_TEMP) put_bits(c, temp,   32);
+
+    c.delta = 0;
+    c.lead  = c.trail = 32;
+    c.temp  = temp;
+  } else {
+    int32_t delta = s.time - c.time;
+
+    put_value(c, zigzag(delta - c.delta), time_width, sizeof (time_width));
+    c.delta = delta;
+
+    if (mask & STORAGE_MASK_ADC) {
+      put_value(c, zigzag(s.adc - c.adc), adc_width, sizeof (adc_width));
+    }
+    if (mask & STORAGE_MASK_TEMP) {
+      put_temp(c, temp);
     }
   }
+
+  c.time = s.time;
+  c.adc  = s.adc;
 }
 
-static void append_values(void) {
-  uint32_t mask = p->storage_mask;
+static void decode(Codec &c, Sample &s, uint8_t mask, bool first) {
+  if (first) {
+    c.time = get_bits(c, 32);
+    if (mask & STORAGE_MASK_ADC)  c.adc  = get_bits(c, 16);
+    if (mask & STORAGE_MASK_TEMP) c.temp = get_bits(c, 32);
+
+    c.delta = 0;
+    c.lead  = c.trail = 32;
+  } else {
+    c.delta += unzigzag(get_value(c, time_width, sizeof (time_width)));
+    c.time  += c.delta;
+
+    if (mask & STORAGE_MASK_ADC) {
+      c.adc += unzigzag(get_value(c, adc_width, sizeof (adc_width)));
+    }
+    if (mask & STORAGE_MASK_TEMP) {
+      get_temp(c);
+    }
+  }
+
+  s.time = c.time;
+  s.adc  = c.adc;
+  memcpy(&s.temp, &c.temp, sizeof (s.temp));
+}
+
+static void print_sample(Print &out, const Sample &s, uint8_t mask) {
   String csv;
 
-  if (!csv.reserve(256)) {
-    log_print(F("CSV:  failed to allocate line buffer"));
+  if (!csv.reserve(64)) {
+    log_print(F("STOR: failed to allocate line buffer"));
   }
 
-  // make CSV line
-  DateTime dt(clock_time());
+  DateTime dt(s.time);
   dt.ConvertToLocalTime();
-  csv += String(clock_time())   + F(";"); // timestamp
-  csv += dt.str()               + F(";"); // localtime
+  csv += String(s.time) + F(";"); // timestamp
+  csv += dt.str()       + F(";"); // localtime
+
+  if (mask & STORAGE_MASK_ADC)  csv += String(s.adc);
+  csv += F(";");
+  if (mask & STORAGE_MASK_TEMP) csv += float2str(s.temp);
+  csv += F("\r\n");
+
+  out.print(csv);
+}
+
+static void print_block(Print &out, uint8_t *buf, const StorageBlock &block) {
+  Codec c;
+  Sample s;
+
+  memset(&c, 0, sizeof (c));
+  c.buf = buf;
+
+  for (int i=0; i<block.count; i++) {
+    decode(c, s, block.mask, i == 0);
+    print_sample(out, s, block.mask);
+  }
+}
 
-  if (mask & STORAGE_MASK_ADC)  csv += String(analogRead(17)) + F(";");
-  if (mask & STORAGE_MASK_TEMP) csv += float2str(rtc_temp())  + F(";");
+static void start_block(void) {
+  memset(&p->block, 0, sizeof (p->block));
+  memset(&p->codec, 0, sizeof (p->codec));
+  memset(p->buf, 0, sizeof (p->buf));
 
-  // replace the last ';' with '\r' and append '\n'
-  csv[csv.length() - 1] = '\r'; csv += F("\n");
+  p->block.magic = STORAGE_MAGIC;
+  p->block.mask  = p->storage_mask & (STORAGE_MASK_ADC | STORAGE_MASK_TEMP);
+  p->codec.buf   = p->buf;
+}
+
+static bool read_entry(File &index, int i, StorageIndex &entry) {
+  if (!index.seek(i * sizeof (StorageIndex), SeekSet)) return (false);
+
+  return (index.read((uint8_t *)&entry, sizeof (entry)) == sizeof (entry));
+}
+
+static bool read_header(File &data, uint32_t offset, StorageBlock &block) {
+  if (!data.seek(offset, SeekSet)) return (false);
+  if (data.read((uint8_t *)&block, sizeof (block)) != sizeof (block)) return (false);
+  if (block.magic != STORAGE_MAGIC) return (false);
+  if (block.len > STORAGE_BLOCK_SIZE) return (false);
 
-  if (!f) open_file();
+  return ((offset + sizeof (block) + block.len) <= data.size());
+}
+
+// counts the blocks in the index, blocks missing in it (power loss after
+// the block was written) are added, an index that doesn't match the data
+// file (deleted or broken) is built again
+static void scan(void) {
+  String data_name = file_name(F(".tsd"));
+  String index_name = file_name(F(".tsi"));
+  StorageBlock block;
+  StorageIndex entry;
+  uint32_t end = 0;
+  int entries = 0;
+  File data, index;
+
+  p->blocks = 0;
 
-  if (f) {
-    f.print(csv);
-    f.flush();
+  if (!rootfs->exists(data_name)) {
+    rootfs->remove(index_name);
+
+    return;
+  }
+
+  data = rootfs->open(data_name, "r");
+
+  if (rootfs->exists(index_name)) {
+    index = rootfs->open(index_name, "r");
+    entries = index.size() / sizeof (StorageIndex);
+
+    if ((index.size() % sizeof (StorageIndex)) ||
+        (entries && (!read_entry(index, entries - 1, entry) ||
+                     !read_header(data, entry.offset, block)))) {
+      log_print(F("STOR: index does not match data file, rebuilding it"));
+
+      entries = 0;
+    } else if (entries) {
+      end = entry.offset + sizeof (block) + block.len;
+    }
+
+    index.close();
+
+    if (!entries) rootfs->remove(index_name);
+  }
+
+  p->blocks = entries;
+
+  while ((end + sizeof (block)) <= data.size()) {
+    if (!read_header(data, end, block)) {
+      log_print(F("STOR: broken block at offset %u"), end);
+
+      break;
+    }
+
+    entry.max = block.max;
+    entry.offset = end;
+
+    index = rootfs->open(index_name, "a");
+    index.write((const uint8_t *)&entry, sizeof (entry));
+    index.close();
+
+    end += sizeof (block) + block.len;
+    p->blocks++;
+  }
+
+  data.close();
+}
+
+static void write_block(void) {
+  StorageIndex entry;
+  File data, index;
+
+  if (!p->block.count) return;
+
+  p->block.len = (p->codec.pos + 7) / 8;
+  p->block.crc = block_crc(p->buf, p->block.len);
+
+  if (rootfs) {
+    // the files may have been deleted in the meantime
+    scan();
+
+    data = rootfs->open(file_name(F(".tsd")), "a");
+  }
+
+  if (data) {
+    entry.max = p->block.max;
+    entry.offset = data.size();
+
+    data.write((const uint8_t *)&p->block, sizeof (StorageBlock));
+    data.write(p->buf, p->block.len);
+    data.close();
+
+    index = rootfs->open(file_name(F(".tsi")), "a");
+    index.write((const uint8_t *)&entry, sizeof (entry));
+    index.close();
+
+    p->blocks++;
   } else {
-    log_print(F("CSV:  cannot write data to file"));
+    log_print(F("STOR: cannot write data to file"));
+  }
+
+  start_block();
+}
+
+static void append_values(void) {
+  uint32_t mask = p->storage_mask;
+  StorageBlock &block = p->block;
+  Sample s;
+
+  s.time = clock_time();
+  s.adc  = (mask & STORAGE_MASK_ADC)  ? analogRead(17) : 0;
+  s.temp = (mask & STORAGE_MASK_TEMP) ? rtc_temp()     : 0.0;
+
+  // start a new block when this one is full or spans too much time
+  if (block.count) {
+    if (((p->codec.pos + STORAGE_SAMPLE_MAX) > (STORAGE_BLOCK_SIZE * 8)) ||
+        ((s.time - block.min) >= STORAGE_BLOCK_SPAN)) {
+      write_block();
+    }
+  }
+
+  encode(p->codec, s, block.mask, block.count == 0);
+
+  if (!block.count || (s.time < block.min)) block.min = s.time;
+  if (!block.count || (s.time > block.max)) block.max = s.time;
+
+  block.count++;
+}
+
+void storage_csv_header(Print &out) {
+  out.print(F("timestamp;localtime;adc;temp\r\n"));
+}
+
+bool storage_csv_block(Print &out, int n) {
+  uint8_t buf[STORAGE_BLOCK_SIZE];
+  StorageBlock block;
+  StorageIndex entry;
+  File data, index;
+  bool ok = false;
+
+  if (!p || (n < 0)) return (false);
+
+  // the block still being filled comes last
+  if (n >= p->blocks) {
+    if ((n > p->blocks) || !p->block.count) return (false);
+
+    print_block(out, p->buf, p->block);
+
+    return (true);
   }
+
+  if (!rootfs) return (false);
+
+  index = rootfs->open(file_name(F(".tsi")), "r");
+  data = rootfs->open(file_name(F(".tsd")), "r");
+
+  if (index && data && read_entry(index, n, entry)) {
+    if (read_header(data, entry.offset, block)) {
+      ok = (data.read(buf, block.len) == block.len);
+    }
+  }
+
+  index.close();
+  data.close();
+
+  if (!ok) return (false);
+
+  if (block.crc != block_crc(buf, block.len)) {
+    log_print(F("STOR: block %i is corrupted, skipping it"), n);
+
+    return (true);
+  }
+
+  print_block(out, buf, block);
+
+  return (true);
+}
+
+int storage_find(uint32_t time) {
+  int lo = 0, hi, mid;
+  StorageIndex entry;
+  File index;
+
+  if (!p || !rootfs) return (0);
+
+  hi = p->blocks;
+
+  index = rootfs->open(file_name(F(".tsi")), "r");
+
+  if (!index) return (0);
+
+  // the first block with samples not older than time
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+
+    if (!read_entry(index, mid, entry)) break;
+
+    if (entry.max < time) lo = mid + 1; else hi = mid;
+  }
+
+  index.close();
+
+  return (lo);
 }
 
 int storage_state(void) {
@@ -130,7 +529,7 @@ bool storage_init(void) {
   fs_init();
 
   if (bootup && !config->storage_enabled) {
-    log_print(F("CSV:  local storage disabled in config"));
+    log_print(F("STOR: local storage disabled in config"));
 
     //fs_fini(); XXX log may still need the FS (TODO impl. ref-count)
     config_fini();
@@ -138,26 +537,36 @@ bool storage_init(void) {
     return (false);
   }
 
-  log_print(F("CSV:  initializing local storage"));
+  log_print(F("STOR: initializing local storage"));
 
-  p = (CSV_PrivateData *)malloc(sizeof (CSV_PrivateData));
-  memset(p, 0, sizeof (CSV_PrivateData));
+  p = (STORAGE_PrivateData *)malloc(sizeof (STORAGE_PrivateData));
+  memset(p, 0, sizeof (STORAGE_PrivateData));
 
   p->storage_interval = config->storage_interval;
   p->storage_mask     = config->storage_mask;
 
   config_fini();
 
+  start_block();
+
+  if (rootfs) {
+    scan();
+
+    log_print(F("STOR: %i blocks in '%s'"),
+      p->blocks, file_name(F(".tsd")).c_str()
+    );
+  }
+
   return (true);
 }
 
 bool storage_fini(void) {
   if (!p) return (false);
 
-  log_print(F("CVS:  disabling local file storage"));
+  log_print(F("STOR: disabling local file storage"));
 
-  // close file
-  f.close();
+  // samples of the last block would be lost otherwise
+  write_block();
 
   // free private data
   free(p);
@@ -175,24 +584,8 @@ void storage_poll(void) {
 
     ms = millis();
 
-    if (f) {
-      if (rootfs) {
-        // check if the file has been deleted
-        if (!f.seek(0, SeekCur)) {
-          log_print(F("CSV:  file was deleted, closing it"));
-
-          f.close();
-        }
-      } else {
-        // check if FS is still mounted
-        log_print(F("CSV:  filesystem was unmounted, closing file"));
-
-        f.close();
-      }
-    }
-
     if ((minute != last_time_minute) && ((minute % p->storage_interval) == 0)) {
-      // write values to file
+      // add values to the current block
       append_values();
 
       // remember minutes for next round
@@ -20,9 +20,19 @@
 #ifndef _STORAGE_H_
 #define _STORAGE_H_
 
+#include <Arduino.h>
+
 int storage_state(void);
 bool storage_init(void);
 bool storage_fini(void);
 void storage_poll(void);
 
+// CSV export, one block of samples at a time. storage_csv_block() returns
+// false if there is no block n, the block still being filled is the last
+void storage_csv_header(Print &out);
+bool storage_csv_block(Print &out, int n);
+
+// the first block with samples at or after time
+int storage_find(uint32_t time);
+
 #endif // _STORAGE_H_
@@ -29,6 +29,7 @@ extern "C" {
 
 #include "websocket.h"
 #include "datetime.h"
+#include "telnet.h"
 #include "config.h"
 #include "clock.h"
 #include "xxtea.h"
@@ -522,44 +523,27 @@ void system_ap_info(String &str) {
 }
 
 void system_wifi_info(String &str) {
-  const String &wifi_list_str = net_list_wifi();
-  String ssid, rssi, crypt;
-  int n = 0, parse = 0;
+  int n = net_wifi_count();
 
-  if (wifi_list_str.length() != 0) {
+  if (n != 0) {
     str += F("WIFI NETWORKS\r\n\r\n");
   }
 
-  for (char c : wifi_list_str) {
-    if (c == '\t') {
-      parse = 1;
-    } else if (c == '\b') {
-      parse = 2;
-    } else if (c == '\r') {
-      parse = 0;
-
-      str += F("          ");
-      str += (n<10) ? F(" ") : F("");
-      str += String(n++) + F(": ");
-      str += ssid  + F(" ");
-      str += rssi  + F("% ");
-      str += crypt + F("\r\n");
-
-      ssid = rssi = crypt = "";
-    } else {
-      if (parse == 0) {
-        ssid += c;
-      } else if (parse == 1) {
-        rssi += c;
-      } else {
-        crypt += c;
-      }
-    }
+  for (int i=0; i<n; i++) {
+    const WiFiNetwork &net = net_wifi_network(i);
+
+    str += F("          ");
+    str += (i<10) ? F(" ") : F("");
+    str += String(i) + F(": ");
+    str += String(net.ssid) + F(" ");
+    str += String(net.rssi + 100) + F("% ");
+    str += String(net.auth) + F("\r\n");
   }
 }
 
 void system_reboot(void) {
   websocket_broadcast_message(F("reboot"));
+  telnet_broadcast_message(F("system is going down for reboot"));
 
   log_print(F("SYS:  shutting down ..."));
 
@@ -23,6 +23,14 @@
 #include <Arduino.h>
 #include <limits.h>
 
+// RTC user memory (system_rtc_mem_*) is addressed in 4 byte blocks from
+// 64 to 191 and survives resets and deep sleep, but not a power cycle.
+// the boot loader takes its OTA command from block 128 on, so a crash
+// report is lost if the next reboot installs an update.
+#define RTC_MEM_NET    64 // net.cpp, 8 blocks
+#define RTC_MEM_DUTY   72 // duty.cpp, 51 blocks
+#define RTC_MEM_CRASH 123 // crash.cpp, 66 blocks
+
 typedef struct SysLoad {
   uint8_t cpu;
   uint8_t mem;
@@ -22,6 +22,7 @@
 #include "system.h"
 #include "module.h"
 #include "clock.h"
+#include "duty.h"
 #include "mqtt.h"
 #include "log.h"
 #include "net.h"
@@ -59,6 +60,10 @@ struct TELEMETRY_PrivateData {
 
 static TELEMETRY_PrivateData *p = NULL;
 
+// kept outside of p, so they survive a restart of the module
+static uint32_t publish_count = 0;
+static uint32_t publish_failed = 0;
+
 static void receive_cb(char *mqtt_topic, byte *payload, unsigned int length) {
   char buf[length + 1];
   char *c = buf;
@@ -69,14 +74,22 @@ static void receive_cb(char *mqtt_topic, byte *payload, unsigned int length) {
   log_print(F("MQTT: message [%s] %s"), mqtt_topic, buf);
 }
 
-static void publish(const String &t, const String &m) {
+static bool publish(const String &t, const String &m, bool retained = true) {
+  bool ret;
+
   led_flash(LED_YEL);
 
-  p->mqtt->publish(t.c_str(), m.c_str(), true); // true = retained
+  if ((ret = p->mqtt->publish(t.c_str(), m.c_str(), retained))) {
+    publish_count++;
+  } else {
+    publish_failed++;
+  }
 
   if (m.length() + t.length() + 5 + 2 > MQTT_MAX_PACKET_SIZE) {
     log_print(F("MQTT: packet of %i bytes is too big"), m.length());
   }
+
+  return (ret);
 }
 
 static void publish_values(void) {
@@ -174,7 +187,8 @@ static void poll_connection(void) {
 
           log_print(F("MQTT: connected to broker (%s)"), p->url);
 
-          publish_poweron();
+          // waking up from deep sleep is not a power on
+          if (!duty_cycling()) publish_poweron();
         }
       }
     }
@@ -194,6 +208,18 @@ static void poll_publish(void) {
   }
 }
 
+// not retained, every message counts
+bool telemetry_publish(const String &topic, const String &msg) {
+  if (!telemetry_connected()) return (false);
+
+  return (publish(p->mqtt_topic + topic, msg, false));
+}
+
+void telemetry_stats(uint32_t &published, uint32_t &failed) {
+  published = publish_count;
+  failed = publish_failed;
+}
+
 bool telemetry_connected(void) {
   if (!p) return (false);
 
@@ -243,8 +269,8 @@ bool telemetry_init(void) {
  
   config_fini();
 
-  // initially we try to connect fast
-  p->reconnection_delay = 5;
+  // initially we try to connect fast, a duty cycle can't wait at all
+  p->reconnection_delay = duty_cycling() ? 0 : 5;
 
   p->mqtt = new MQTT(p->url, MQTT_PORT, SERVER_FINGERPRINT);
   p->mqtt->ReceiveCallback(receive_cb);
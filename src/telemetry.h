@@ -20,6 +20,8 @@
 #ifndef _TELEMETRY_H_
 #define _TELEMETRY_H_
 
+#include <Arduino.h>
+
 int telemetry_state(void);
 bool telemetry_init(void);
 bool telemetry_fini(void);
@@ -28,4 +30,8 @@ void telemetry_poll(void);
 bool telemetry_connected(void);
 bool telemetry_enabled(void);
 
+bool telemetry_publish(const String &topic, const String &msg);
+
+void telemetry_stats(uint32_t &published, uint32_t &failed);
+
 #endif // _TELEMETRY_H_
@@ -17,6 +17,7 @@
     Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
 */
 
+#include "message.h"
 #include "system.h"
 #include "module.h"
 #include "config.h"
@@ -303,6 +304,31 @@ static void telnet_process(telnet_t *session) {
   }
 }
 
+void telnet_broadcast_message(const String &str) {
+  Message *msg;
+
+  if (!p) return;
+
+  // the notice is formatted once and then written to all sessions
+  msg = message_new(str.length() + 16);
+
+  msg->data += F("\r\n\033[1m*** ");
+  msg->data += str;
+  msg->data += F(" ***\033[0m\r\n");
+
+  for (int i=0; i<TELNET_SESSIONS; i++) {
+    telnet_t *session = p->session[i];
+
+    if (session && (session->state == TELNET_STATE_RUNNING)) {
+      session->client.write(
+        (const uint8_t *)message_payload(msg), message_length(msg)
+      );
+    }
+  }
+
+  message_unref(msg);
+}
+
 int telnet_state(void) {
   if (p) return (MODULE_STATE_ACTIVE);
 
@@ -432,6 +458,8 @@ bool telnet_fini(void) {
 
 void telnet_poll(void) {}
 
+void telnet_broadcast_message(const String &str) {}
+
 #endif // RELEASE
 
 MODULE(telnet)
@@ -20,9 +20,13 @@
 #ifndef _TELNET_H_
 #define _TELNET_H_
 
+#include <Arduino.h>
+
 int telnet_state(void);
 bool telnet_init(void);
 bool telnet_fini(void);
 void telnet_poll(void);
 
+void telnet_broadcast_message(const String &str);
+
 #endif // _TELNET_H_
@@ -0,0 +1,99 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#include "template.h"
+
+// LZSS with a 256 byte window. each flag byte describes the following
+// eight items, LSB first: a set bit is a literal byte, a cleared bit a
+// back reference of two bytes (distance - 1, length - 3). a NUL byte
+// in the decompressed stream marks a placeholder, the next byte is its
+// index. placeholders are resolved while decompressing, so the template
+// never exists uncompressed in RAM, it goes straight to the output.
+
+#define TEMPLATE_WINDOW    256
+#define TEMPLATE_MIN_MATCH   3
+#define TEMPLATE_CHUNK      64
+
+struct Decoder {
+  Print *out;
+  TemplateCallback cb;
+
+  uint8_t window[TEMPLATE_WINDOW];
+  uint8_t pos;         // wraps around with the window
+
+  bool var;            // previous byte was a placeholder marker
+
+  uint8_t buf[TEMPLATE_CHUNK];
+  uint8_t len;
+};
+
+static void flush(Decoder &d) {
+  if (d.len == 0) return;
+
+  d.out->write(d.buf, d.len);
+  d.len = 0;
+}
+
+static void emit(Decoder &d, uint8_t c) {
+  d.window[d.pos++] = c;
+
+  if (d.var) {
+    flush(d);
+    d.cb(*d.out, c);
+    d.var = false;
+  } else if (c == '\0') {
+    d.var = true;
+  } else {
+    d.buf[d.len++] = c;
+
+    if (d.len == TEMPLATE_CHUNK) flush(d);
+  }
+}
+
+void template_render(Print &out, const Template *tpl, TemplateCallback cb) {
+  Template t;
+  Decoder d;
+  uint16_t i = 0;
+
+  memcpy_P(&t, tpl, sizeof (Template));
+
+  d.out = &out;
+  d.cb  = cb;
+  d.pos = 0;
+  d.var = false;
+  d.len = 0;
+
+  while (i < t.length) {
+    uint8_t flags = pgm_read_byte(t.data + i++);
+
+    for (int bit=0; (bit<8) && (i<t.length); bit++, flags >>= 1) {
+      if (flags & 1) {
+        emit(d, pgm_read_byte(t.data + i++));
+      } else {
+        int dist = pgm_read_byte(t.data + i++) + 1;
+        int len = pgm_read_byte(t.data + i++) + TEMPLATE_MIN_MATCH;
+        uint8_t from = d.pos - dist;
+
+        while (len--) emit(d, d.window[from++]);
+      }
+    }
+  }
+
+  flush(d);
+}
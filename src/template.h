@@ -0,0 +1,37 @@
+/*
+    This file is part of Genesys.
+
+    Genesys is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Genesys is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+*/
+
+#ifndef _TEMPLATE_H_
+#define _TEMPLATE_H_
+
+#include <Arduino.h>
+
+// a compressed HTML template in flash, generated by templates.pl
+struct Template {
+  const uint8_t *data;
+  uint16_t length;     // compressed
+  uint16_t size;       // decompressed, placeholders not expanded
+};
+
+// called for every placeholder, prints the value to out
+typedef void (*TemplateCallback)(Print &out, uint8_t var);
+
+void template_render(Print &out, const Template *tpl, TemplateCallback cb);
+
+#endif // _TEMPLATE_H_
@@ -0,0 +1,133 @@
+#!/usr/bin/perl
+#
+# This file is part of Genesys.
+#
+# Genesys is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Genesys is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Genesys.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
+#
+# Compresses the HTML templates into PROGMEM arrays.
+#
+# usage: templates.pl <file> ... > webtemplates.h
+#
+# Placeholders ({{name}}) are replaced by a NUL byte followed by the
+# index of the name in the TPL_VAR_* enum, then the template is LZSS
+# compressed with a 256 byte window (see template.cpp for the format).
+
+use strict;
+use warnings;
+
+use File::Basename;
+
+use constant WINDOW    => 256;
+use constant MIN_MATCH => 3;
+use constant MAX_MATCH => 255 + MIN_MATCH;
+
+sub compress {
+  my ($in) = @_;
+  my @src = unpack('C*', $in);
+  my ($out, $flags, $items, $bit) = ('', 0, '', 0);
+  my $pos = 0;
+
+  while ($pos < @src) {
+    my ($best_len, $best_dist) = (0, 0);
+    my $start = ($pos > WINDOW) ? $pos - WINDOW : 0;
+
+    for (my $i=$start; $i<$pos; $i++) {
+      my $len = 0;
+
+      $len++ while (($pos + $len < @src) && ($len < MAX_MATCH) &&
+                    ($src[$i + $len] == $src[$pos + $len]));
+
+      ($best_len, $best_dist) = ($len, $pos - $i) if ($len > $best_len);
+    }
+
+    if ($best_len >= MIN_MATCH) {
+      # flag bit 0: reference (distance - 1, length - MIN_MATCH)
+      $items .= pack('CC', $best_dist - 1, $best_len - MIN_MATCH);
+      $pos += $best_len;
+    } else {
+      # flag bit 1: literal
+      $flags |= (1 << $bit);
+      $items .= pack('C', $src[$pos++]);
+    }
+
+    if (++$bit == 8) {
+      $out .= pack('C', $flags) . $items;
+      ($flags, $items, $bit) = (0, '', 0);
+    }
+  }
+
+  $out .= pack('C', $flags) . $items if ($bit);
+
+  return $out;
+}
+
+sub c_array {
+  my ($data) = @_;
+  my @bytes = map { sprintf('0x%02x', $_) } unpack('C*', $data);
+  my $str = '';
+
+  while (my @row = splice(@bytes, 0, 12)) {
+    $str .= '  ' . join(', ', @row) . ",\n";
+  }
+
+  return $str;
+}
+
+my (%templates, %vars);
+
+foreach my $file (sort @ARGV) {
+  my $name = fileparse($file, qr/\.[^.]*/);
+
+  open(my $fh, '<:raw', $file) or die "$file: $!\n";
+  $templates{$name} = do { local $/; <$fh> };
+  close($fh);
+
+  $vars{$1} = 1 while ($templates{$name} =~ /\{\{(\w+)\}\}/g);
+}
+
+my @vars = sort keys %vars;
+my %index = map { $vars[$_] => $_ } 0 .. $#vars;
+
+die "too many placeholders\n" if (@vars > 256);
+
+print "// generated by templates.pl, do not edit\n\n";
+
+print "enum {\n";
+print "  TPL_VAR_" . uc($_) . ",\n" foreach (@vars);
+print "  TPL_VAR_COUNT\n";
+print "};\n\n";
+
+my ($total_raw, $total_out) = (0, 0);
+
+foreach my $name (sort keys %templates) {
+  my $data = $templates{$name};
+
+  $data =~ s/\{\{(\w+)\}\}/pack('CC', 0, $index{$1})/ge;
+
+  my $lz = compress($data);
+
+  $total_raw += length($data);
+  $total_out += length($lz);
+
+  print "static const uint8_t tpl_${name}_data[] PROGMEM = {\n";
+  print c_array($lz);
+  print "};\n\n";
+
+  printf "static const Template tpl_%s PROGMEM = { tpl_%s_data, %d, %d };\n\n",
+    $name, $name, length($lz), length($data);
+}
+
+printf STDERR "  Templates: %d bytes -> %d bytes\n", $total_raw, $total_out;
@@ -17,110 +17,397 @@
     Copyright (C) 2016 Clemens Kirchgatterer <clemens@1541.org>.
 */
 
-#include <ESP8266HTTPClient.h>
-#include <ESP8266httpUpdate.h>
-
-#include "system.h"
-#include "module.h"
-#include "config.h"
-#include "net.h"
-#include "log.h"
-
-#include "update.h"
-
-struct UPD_PrivateData {
-  ESP8266HTTPUpdate *upd;
-
-  // settings from config
-  uint32_t update_interval;
-  char     update_url[64];
-};
-
-static UPD_PrivateData *p = NULL;
-
-static int check_for_update(void) {
-  HTTPUpdateResult result;
-
-  result = p->upd->update(p->update_url, FIRMWARE);
-
-  if (result == HTTP_UPDATE_FAILED) {
-      log_print(F("UPD:  %s"),
-        p->upd->getLastErrorString().c_str()
-      );
-
-      // uncomment if failed updates should be retried next minute
-      // return (-1);
-  } else if (result == HTTP_UPDATE_NO_UPDATES) {
-    log_print(F("UPD:  no update available"));
-  } else if (result == HTTP_UPDATE_OK) {
-    log_print(F("UPD:  update successful"));
-  }
-
-  return (0);
-}
-
-int update_state(void) {
-  if (p) return (MODULE_STATE_ACTIVE);
-
-  return (MODULE_STATE_INACTIVE);
-}
-
-bool update_init(void) {
-  if (p) return (false);
-
-  config_init();
-
-  if (bootup && !config->update_enabled) {
-    log_print(F("UPD:  http update disabled in config"));
-
-    config_fini();
-
-    return (false);
-  }
-
-  log_print(F("UPD:  initializing http update"));
-
-  p = (UPD_PrivateData *)malloc(sizeof (UPD_PrivateData));
-  memset(p, 0, sizeof (UPD_PrivateData));
-
-  p->update_interval = config->update_interval;
-  strcpy(p->update_url, config->update_url);
-
-  p->upd = new ESP8266HTTPUpdate();
-
-  config_fini();
-
-  return (true);
-}
-
-bool update_fini(void) {
-  if (!p) return (false);
-
-  log_print(F("UPD:  disabling http update"));
-
-  delete (p->upd);
-
-  // free private p->data
-  free(p);
-  p = NULL;
-
-  return (true);
-}
-
-void update_poll(void) {
-  if (p && net_connected()) {
-    uint32_t interval = p->update_interval * 1000 * 60 * 60;
-    static bool poll_pending = true;
-    static uint32_t ms = millis();
-
-    if (poll_pending) interval = 60 * 1000;
-
-    if ((millis() - ms) > interval) {
-      ms = millis();
-
-      poll_pending = (check_for_update() < 0);
-    }
-  }
-}
-
-MODULE(update)
+#include <ESP8266HTTPClient.h>
+
+#include "system.h"
+#include "module.h"
+#include "config.h"
+#include "ota.h"
+#include "net.h"
+#include "log.h"
+
+#include "update.h"
+
+// give up if the server stalls for that long (ms)
+#define UPDATE_TIMEOUT 10000
+
+// first check after boot, spread per device over UPDATE_JITTER (ms)
+#define UPDATE_DELAY   (60 * 1000)
+#define UPDATE_JITTER  (15 * 60 * 1000)
+
+// failed checks are retried after UPDATE_RETRY, doubled every time
+#define UPDATE_RETRY   (60 * 1000)
+
+// a broken download is resumed after UPDATE_RESUME, at most
+// UPDATE_ATTEMPTS times. the last UPDATE_OVERLAP bytes are requested
+// again and must match what was received before.
+#define UPDATE_RESUME   (10 * 1000)
+#define UPDATE_ATTEMPTS 10
+#define UPDATE_OVERLAP  64
+
+#define DOWNLOAD_OK       0
+#define DOWNLOAD_BROKEN   1 // connection lost, worth another try
+#define DOWNLOAD_REJECTED 2 // the image itself is bad
+
+struct UPD_PrivateData {
+  uint32_t check_ms;     // millis() of the last check
+  uint32_t check_delay;  // until the next one
+  uint8_t failures;
+
+  // the last image that failed to install, not fetched again
+  char etag[48];
+
+  // the download in progress, the OTA session stays open in between
+  bool downloading;
+  uint8_t attempts;
+  uint32_t received;
+  uint8_t tail[UPDATE_OVERLAP];
+  char image[48];        // ETag, for If-Range
+
+  // settings from config
+  uint32_t update_interval;
+  char     update_url[64];
+};
+
+static UPD_PrivateData *p = NULL;
+
+static void stop_download(void) {
+  if (p->downloading) ota_abort();
+
+  p->downloading = false;
+}
+
+static bool start_download(const String &etag, const String &md5) {
+  uint32_t space = (system_free_sketch_space() - 0x1000) & 0xFFFFF000;
+
+  // a restarted download begins with an empty image
+  stop_download();
+
+  // a push via /update or a config store that can't make room
+  if (!ota_begin(space)) {
+    log_print(F("UPD:  can't start the update now"));
+
+    return (false);
+  }
+
+  ota_md5(md5);
+
+  snprintf(p->image, sizeof (p->image), "%s", etag.c_str());
+
+  p->downloading = true;
+  p->attempts    = 0;
+  p->received    = 0;
+
+  return (true);
+}
+
+static void keep_tail(const uint8_t *data, size_t len) {
+  if (len >= UPDATE_OVERLAP) {
+    memcpy(p->tail, data + len - UPDATE_OVERLAP, UPDATE_OVERLAP);
+  } else {
+    memmove(p->tail, p->tail + len, UPDATE_OVERLAP - len);
+    memcpy(p->tail + UPDATE_OVERLAP - len, data, len);
+  }
+}
+
+// overlap is the number of bytes that were already received before
+static int download(HTTPClient &http, uint32_t overlap) {
+  WiFiClient *stream = http.getStreamPtr();
+  int remaining = http.getSize();
+  uint32_t ms = millis();
+  uint8_t buf[256];
+
+  while (http.connected() && (remaining != 0)) {
+    size_t len = stream->available();
+    uint8_t *data = buf;
+
+    if (len == 0) {
+      if ((millis() - ms) > UPDATE_TIMEOUT) {
+        log_print(F("UPD:  download timed out"));
+
+        return (DOWNLOAD_BROKEN);
+      }
+
+      system_yield();
+
+      continue;
+    }
+
+    len = stream->readBytes(buf, min(len, sizeof (buf)));
+
+    if (remaining > 0) remaining -= len;
+
+    ms = millis();
+
+    if (overlap) {
+      size_t n = min(len, overlap);
+
+      if (memcmp(data, p->tail + UPDATE_OVERLAP - overlap, n)) {
+        log_print(F("UPD:  image changed on the server"));
+
+        stop_download();
+
+        return (DOWNLOAD_BROKEN);
+      }
+
+      overlap -= n;
+      data += n;
+      len -= n;
+    }
+
+    if (len == 0) continue;
+
+    if (ota_write(data, len) != len) {
+      p->downloading = false;
+
+      ota_abort();
+
+      return (DOWNLOAD_REJECTED);
+    }
+
+    keep_tail(data, len);
+
+    p->received += len;
+  }
+
+  if (remaining > 0) {
+    log_print(F("UPD:  connection lost after %u bytes"), p->received);
+
+    return (DOWNLOAD_BROKEN);
+  }
+
+  p->downloading = false;
+
+  return (ota_end() ? DOWNLOAD_OK : DOWNLOAD_REJECTED);
+}
+
+static int32_t range_start(HTTPClient &http) {
+  String range = http.header("Content-Range");
+
+  if (!range.startsWith(F("bytes "))) return (-1);
+
+  return (range.substring(6).toInt());
+}
+
+// deterministic per device, so a fleet that boots at once is spread out
+static uint32_t jitter(uint32_t range) {
+  uint32_t hash = 2166136261;
+
+  for (const char *c=device_id; *c; c++) {
+    hash = (hash ^ *c) * 16777619;
+  }
+
+  return (hash % range);
+}
+
+static void request(HTTPClient &http) {
+  const char *keys[] = { "x-MD5", "ETag", "Retry-After", "Content-Range" };
+
+  http.begin(p->update_url);
+
+  // same request as ESP8266HTTPUpdate, so existing servers keep working
+  http.setUserAgent(F("ESP8266-http-Update"));
+  http.addHeader(F("x-ESP8266-STA-MAC"), net_mac());
+  http.addHeader(F("x-ESP8266-AP-MAC"), net_ap_mac());
+  http.addHeader(F("x-ESP8266-free-space"), String(system_free_sketch_space()));
+  http.addHeader(F("x-ESP8266-sketch-size"), String(system_sketch_size()));
+  http.addHeader(F("x-ESP8266-chip-size"), String(ESP.getFlashChipRealSize()));
+  http.addHeader(F("x-ESP8266-sdk-version"), ESP.getSdkVersion());
+  http.addHeader(F("x-ESP8266-mode"), F("sketch"));
+  http.addHeader(F("x-ESP8266-version"), FIRMWARE);
+
+  // we can take images packed by ota.pl and deltas against FIRMWARE
+  http.addHeader(F("x-genesys-image"), F("lz, delta"));
+
+  if (p->etag[0]) http.addHeader(F("If-None-Match"), p->etag);
+
+  http.collectHeaders(keys, 4);
+}
+
+// returns the time until the next check
+static uint32_t retry(HTTPClient &http) {
+  uint32_t interval = p->update_interval * 1000 * 60 * 60;
+  uint32_t delay = UPDATE_RETRY << min(p->failures, 10);
+  String after = http.header("Retry-After");
+
+  if (p->failures < UINT8_MAX) p->failures++;
+
+  // the server knows best when it can take us again
+  if (after.length() && (after.toInt() > 0)) {
+    delay = min((uint32_t)after.toInt(), interval / 1000) * 1000;
+  } else if (delay > interval) {
+    delay = interval;
+  }
+
+  log_print(F("UPD:  next check in %u s"), delay / 1000);
+
+  return (delay + jitter(UPDATE_RETRY));
+}
+
+// returns the time until the next check
+static uint32_t fetch(void) {
+  uint32_t overlap = min(p->received, UPDATE_OVERLAP);
+  uint32_t next = p->update_interval * 1000 * 60 * 60;
+  HTTPClient http;
+  int code, ret;
+
+  request(http);
+
+  if (p->received) {
+    log_print(F("UPD:  resuming download at %u bytes"), p->received);
+
+    http.addHeader(F("Range"), "bytes=" + String(p->received - overlap) + "-");
+
+    // the server sends the whole image if it has changed meanwhile
+    if (p->image[0]) http.addHeader(F("If-Range"), p->image);
+  } else {
+    log_print(F("UPD:  downloading update ..."));
+  }
+
+  code = http.GET();
+
+  if (p->received && (code == HTTP_CODE_PARTIAL_CONTENT) &&
+      (range_start(http) == (int32_t)(p->received - overlap))) {
+    ret = download(http, overlap);
+  } else if (code == HTTP_CODE_OK) {
+    bool started = true;
+
+    if (p->received) {
+      log_print(F("UPD:  restarting download"));
+
+      started = start_download(http.header("ETag"), http.header("x-MD5"));
+    }
+
+    ret = (started) ? download(http, 0) : DOWNLOAD_BROKEN;
+  } else {
+    log_print(F("UPD:  download failed (%i) %s"),
+      code, http.errorToString(code).c_str()
+    );
+
+    ret = DOWNLOAD_BROKEN;
+  }
+
+  if (ret == DOWNLOAD_OK) {
+    log_print(F("UPD:  update successful"));
+
+    system_reboot();
+  } else if (ret == DOWNLOAD_REJECTED) {
+    // don't fetch the same broken image again and again
+    snprintf(p->etag, sizeof (p->etag), "%s", p->image);
+
+    next = retry(http);
+  } else if (p->downloading && (++p->attempts < UPDATE_ATTEMPTS)) {
+    // keep what we have and pick up from there soon
+    next = UPDATE_RESUME + jitter(UPDATE_RESUME);
+  } else {
+    stop_download();
+
+    next = retry(http);
+  }
+
+  http.end();
+
+  return (next);
+}
+
+static uint32_t check_for_update(void) {
+  uint32_t interval = p->update_interval * 1000 * 60 * 60;
+  HTTPClient http;
+  int code;
+
+  // a broken download is continued without asking again
+  if (p->downloading) return (fetch());
+
+  // an image is being pushed via /update right now
+  if (ota_active()) return (UPDATE_RESUME + jitter(UPDATE_RESUME));
+
+  // a HEAD request costs a few hundred bytes if there is nothing new
+  request(http);
+  code = http.sendRequest("HEAD");
+
+  if (code == HTTP_CODE_NOT_MODIFIED) {
+    log_print(F("UPD:  no update available"));
+
+    p->failures = 0;
+  } else if (code != HTTP_CODE_OK) {
+    log_print(F("UPD:  update check failed (%i) %s"),
+      code, http.errorToString(code).c_str()
+    );
+
+    interval = retry(http);
+  } else {
+    if (start_download(http.header("ETag"), http.header("x-MD5"))) {
+      p->failures = 0;
+
+      http.end();
+
+      return (fetch());
+    }
+
+    interval = retry(http);
+  }
+
+  http.end();
+
+  return (interval);
+}
+
+int update_state(void) {
+  if (p) return (MODULE_STATE_ACTIVE);
+
+  return (MODULE_STATE_INACTIVE);
+}
+
+bool update_init(void) {
+  if (p) return (false);
+
+  config_init();
+
+  if (bootup && !config->update_enabled) {
+    log_print(F("UPD:  http update disabled in config"));
+
+    config_fini();
+
+    return (false);
+  }
+
+  log_print(F("UPD:  initializing http update"));
+
+  p = (UPD_PrivateData *)malloc(sizeof (UPD_PrivateData));
+  memset(p, 0, sizeof (UPD_PrivateData));
+
+  p->update_interval = config->update_interval;
+  strcpy(p->update_url, config->update_url);
+
+  p->check_ms    = millis();
+  p->check_delay = UPDATE_DELAY + jitter(UPDATE_JITTER);
+
+  config_fini();
+
+  return (true);
+}
+
+bool update_fini(void) {
+  if (!p) return (false);
+
+  log_print(F("UPD:  disabling http update"));
+
+  stop_download();
+
+  // free private p->data
+  free(p);
+  p = NULL;
+
+  return (true);
+}
+
+void update_poll(void) {
+  if (p && net_connected()) {
+    if ((millis() - p->check_ms) > p->check_delay) {
+      p->check_delay = check_for_update();
+      p->check_ms    = millis();
+    }
+  }
+}
+
+MODULE(update)
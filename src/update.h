@@ -37,8 +37,28 @@ function check_header($name, $value = false) {
 }
 
 function sendFile($path) {
+    $accept = isset($_SERVER['HTTP_X_GENESYS_IMAGE']) ? $_SERVER['HTTP_X_GENESYS_IMAGE'] : '';
+    $delta = dirname($path).'/'.$_SERVER['HTTP_X_ESP8266_VERSION'].'-'.basename($path).'.delta';
+
+    // prefer a delta against the running firmware, then the packed image,
+    // both made by ota.pl
+    if(strpos($accept, 'delta') !== false && file_exists($delta)) {
+        $path = $delta;
+    } else if(strpos($accept, 'lz') !== false && file_exists($path.'.lz')) {
+        $path .= '.lz';
+    }
+
+    // the device sends the ETag of an image that failed to install
+    $etag = '"'.md5_file($path).'"';
+
+    if(check_header('HTTP_IF_NONE_MATCH', $etag)) {
+        header($_SERVER["SERVER_PROTOCOL"].' 304 Not Modified', true, 304);
+        return;
+    }
+
     header($_SERVER["SERVER_PROTOCOL"].' 200 OK', true, 200);
     header('Content-Type: application/octet-stream', true);
+    header('ETag: '.$etag, true);
     header('Content-Disposition: attachment; filename='.basename($path));
     header('Content-Length: '.filesize($path), true);
     header('x-MD5: '.md5_file($path), true);
@@ -73,3 +73,17 @@ String formatInt(int32_t value, uint8_t size, char insert) {
 
   return (ret);
 }
+
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len) {
+  const uint8_t *d = (const uint8_t *)data;
+
+  crc = ~crc;
+
+  while (len--) {
+    crc ^= *d++;
+
+    for (int i=0; i<8; i++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+
+  return (~crc);
+}
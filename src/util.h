@@ -32,4 +32,7 @@ int modulo(int a, int b);
 
 const char *int2str(int32_t i);
 
+// CRC-32 (IEEE), pass 0 to start and the last result to continue
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+
 #endif // _UTIL_H_
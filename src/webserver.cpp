@@ -18,8 +18,6 @@
 */
 
 #include <ESP8266WiFi.h>
-#include <ESP8266WebServer.h>
-#include <StreamString.h>
 #include <limits.h>
 #include <FS.h>
 
@@ -27,16 +25,22 @@
 #include "telemetry.h"
 #include "websocket.h"
 #include "storage.h"
+#include "assets.h"
 #include "console.h"
 #include "at24c32.h"
+#include "metrics.h"
 #include "update.h"
+#include "cache.h"
 #include "config.h"
 #include "system.h"
 #include "module.h"
+#include "httpd.h"
 #include "clock.h"
 #include "html.h"
-#include "icon.h"
+#include "api.h"
+#include "ota.h"
 #include "mdns.h"
+#include "util.h"
 #include "led.h"
 #include "ntp.h"
 #include "rtc.h"
@@ -46,47 +50,84 @@
 #include "webserver.h"
 
 #define SESSION_TIMEOUT  3600
-#define HTML_BUFFER_SIZE 2800
+#define SESSION_SYNC      300 // min. expiry advance before it is written back
+#define SESSION_SLOTS       4 // concurrent logins, the oldest one is evicted
+#define SESSION_SWEEP    1000 // ms between two expiry checks
+#define SESSION_EEPROM   0x20 // one 32 byte EEPROM page per slot from here
 
-//#define LOG_PAGE_SIZE
+#define CACHE_TTL_INFO   5000 // ms
+#define CACHE_TTL_FILES 10000
+#define CACHE_TTL_API    1000
 
-struct Session {
-  Session(bool create = true);
-  ~Session(void);
+// a WiFi scan result younger than this is not refreshed by /scan (ms)
+#define WIFI_SCAN_MAX_AGE 10000
 
-  void update(void);
+// inflated asset bytes per producer step, each step starts over
+#define ASSET_STEP 1460
 
-  static Session *load(void);
+// steps page_head() takes at the start of each page producer
+#define PAGE_HEAD_STEPS 2
+
+//#define LOG_PAGE_SIZE
 
-  time_t expires;
-  char   key[16];
+// pages rendered by produce_page()
+enum {
+  PAGE_ROOT,
+  PAGE_CLOCK,
+  PAGE_LOG,
+  PAGE_LOGIN
+};
+
+// expires and key are stored in the EEPROM, the rest lives in RAM only
+struct Session {
+  time_t   expires;    // 0 = slot is unused
+  char     key[16];
+
+  time_t   synced;     // expiry as stored in the EEPROM
+  uint32_t used;       // millis() of the last request, for LRU eviction
 };
 
 struct HTTP_PrivateData {
-  ESP8266WebServer *webserver;
+  HTTPServer *webserver;
 
   uint32_t ap_addr;
 
   char user[17];
   char pass[33];
 
-  Session *session;
+  Session session[SESSION_SLOTS];
+  uint32_t last_sweep;
+
+  bool via_softap;     // origin of the current request
 
-  bool ota_enabled;
   int delayed_reboot;
 };
 
 static HTTP_PrivateData *p = NULL;
 
-// current upload
-File fs_upload_file;
+// SPIFFS logical page, uploads are written in multiples of it
+#define UPLOAD_PAGE_SIZE 256
+
+struct FileUpload {
+  HTTPUpload *owner;   // upload of the connection sending the file
+  File file;
+  String path;
+
+  uint32_t crc;        // CRC-32 of the data received so far
+  size_t written;
+  bool failed;
+  bool finished;       // the file is closed, only the response is left
 
-// global buffer for dynamic HTML code
-static String html;
+  // partial page carried over to the next chunk
+  uint8_t page[UPLOAD_PAGE_SIZE];
+  size_t fill;
+};
 
-static const char PROGMEM image_png_str[]       = "image/png";
-static const char PROGMEM text_javascript_str[] = "text/javascrip";
-static const char PROGMEM text_css_str[]        = "text/css";
+// current upload, only one at a time
+static FileUpload *fs_upload = NULL;
+
+// upload of the connection pushing a firmware image
+static HTTPUpload *ota_upload = NULL;
 
 static const char PROGMEM charset[] = "abcdefghijklmnopqrstuvwxyz"
                                       "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
@@ -113,115 +154,220 @@ static const String get_content_type(const String &filename) {
                                           return (F("text/plain"));
 }
 
-Session::Session(bool create) {
-  bool active = true;
+static uint16_t session_addr(const Session *s) {
+  return (SESSION_EEPROM + (s - p->session) * 32);
+}
 
-  at24c32_write(0x10, &active,  sizeof (active));
+static void session_update(Session *s) {
+  // every request refreshes the expiry, but only in RAM. each EEPROM
+  // write blocks for EEPROM_DELAY, so session_sync() writes it lazily
+  s->expires = system_utc() + SESSION_TIMEOUT;
+  s->used = millis();
+}
 
-  if (create) {
-    for (int n=0; n<sizeof (key) - 1; n++) {
-      key[n] = pgm_read_byte(&charset[RANDOM_REG32 % 62]);
-    }
-    key[sizeof (key) - 1] = '\0';
-    at24c32_write(0x18, key, sizeof (key));
+static void session_sync(Session *s, bool force = false) {
+  if (s->expires == s->synced) return;
+  if (!force && (s->expires - s->synced < SESSION_SYNC)) return;
 
-    update();
-  }
+  at24c32_write(session_addr(s), &s->expires, sizeof (s->expires));
+  s->synced = s->expires;
 }
 
-Session::~Session(void) {
-  bool active = false;
+static void session_close(Session *s) {
+  s->expires = 0;
 
-  at24c32_write(0x10, &active,  sizeof (active));
+  session_sync(s, true);
 }
 
-void Session::update(void) {
-  expires = system_utc() + SESSION_TIMEOUT;
-  at24c32_write(0x14, &expires, sizeof (expires));
-}
+static Session *session_create(void) {
+  Session *s = &p->session[0];
 
-Session *Session::load(void) {
-  Session *s = NULL;
-  bool active;
+  // take a free slot or evict the least recently used session
+  for (int i=0; i<SESSION_SLOTS; i++) {
+    if (!p->session[i].expires) {
+      s = &p->session[i];
+      break;
+    }
 
-  at24c32_read(0x10, &active,  sizeof (active));
+    if ((int32_t)(p->session[i].used - s->used) < 0) s = &p->session[i];
+  }
 
-  if (active) {
-    s = new Session(false); // false = do not create new session
+  if (s->expires) log_print(F("HTTP: session table full, evicting oldest"));
 
-    at24c32_read(0x14, &s->expires, sizeof (s->expires));
-    at24c32_read(0x18, &s->key[0],  sizeof (s->key));
+  for (int n=0; n<sizeof (s->key) - 1; n++) {
+    s->key[n] = pgm_read_byte(&charset[RANDOM_REG32 % 62]);
   }
+  s->key[sizeof (s->key) - 1] = '\0';
+
+  session_update(s);
+
+  // expiry and key in a single page write
+  at24c32_write(session_addr(s), s, offsetof(Session, synced));
+  s->synced = s->expires;
 
   return (s);
 }
 
-static void send_page_P(const char *html, const char *type, int32_t length = -1) {
-  led_flash(LED_YEL);
+static Session *session_find(void) {
+  String cookie, name = F("GENESYS_SESSION_KEY=");
+  Session *found = NULL;
+  const char *key;
+  int pos;
 
-  if (p->session) p->session->update();
+  if (!p->webserver->hasHeader(F("Cookie"))) return (NULL);
 
-  if (length < 0) length = strlen_P((PGM_P)html);
+  cookie = p->webserver->header(F("Cookie"));
+  pos = cookie.indexOf(name);
 
-  p->webserver->sendHeader(F("Cache-Control"), F("max-age=86400"));
-  p->webserver->send_P(200, type, html, length);
+  if (pos < 0) return (NULL);
 
-#ifdef LOG_PAGE_SIZE
-  log_print(F("HTTP: serving (complete) page (flash) -> %i bytes"), length);
-#endif
+  pos += name.length();
+  key = cookie.c_str() + pos;
+
+  if (cookie.length() - pos < sizeof (found->key) - 1) return (NULL);
+
+  // every slot is compared in full, so the response time does
+  // not tell how many characters of a guessed key were right
+  for (int i=0; i<SESSION_SLOTS; i++) {
+    Session *s = &p->session[i];
+    uint8_t diff = 0;
+
+    for (int n=0; n<sizeof (s->key) - 1; n++) diff |= s->key[n] ^ key[n];
+
+    if (!diff && s->expires) found = s;
+  }
+
+  return (found);
 }
 
-static void send_page(String &html,
-                      const String &type,
-                      int code = 200) {
+static void session_load(void) {
+  for (int i=0; i<SESSION_SLOTS; i++) {
+    Session *s = &p->session[i];
+    bool valid;
 
-  led_flash(LED_YEL);
+    at24c32_read(session_addr(s), s, offsetof(Session, synced));
 
-  if (p->session) p->session->update();
+    valid = (s->key[sizeof (s->key) - 1] == '\0');
+    for (int n=0; n<sizeof (s->key) - 1; n++) {
+      if (!isalnum(s->key[n])) valid = false;
+    }
 
-  p->webserver->send(code, type, html);
+    // unused slot or data left behind by an older firmware
+    if (!valid) s->expires = 0;
 
-#ifdef LOG_PAGE_SIZE
-  log_print(F("HTTP: serving (complete) page (RAM) -> %i bytes"), html.length());
-#endif
+    s->synced = s->expires;
+    s->used = 0;
+  }
+}
+
+// a browser with an expired session is sent to the login page by its
+// next request, the other sessions stay logged in
+static void session_sweep(void) {
+  for (int i=0; i<SESSION_SLOTS; i++) {
+    Session *s = &p->session[i];
 
-  // free buffer
-  html = String();
+    if (!s->expires) continue;
+
+    if (system_utc() > s->expires) {
+      log_print(F("HTTP: session timed out"));
+
+      session_close(s);
+    } else {
+      session_sync(s);
+    }
+  }
 }
 
-static void send_page_chunk(String &html) {
+// inflated in steps, for clients that don't accept gzip
+static bool produce_asset(int step, int arg) {
+  uint32_t offset = step * ASSET_STEP;
+  Asset asset;
+  int len;
+
+  if (!asset_find(p->webserver->uri(), asset)) return (false);
+
+  len = asset_inflate(asset, *p->webserver, offset, ASSET_STEP);
+
+  if (len < 0) {
+    log_print(F("HTTP: broken asset %s"), p->webserver->uri().c_str());
+
+    return (false);
+  }
+
+  return ((offset + len) < asset.raw_length);
+}
+
+static void send_asset(const Asset &asset) {
+  String encoding = p->webserver->header(F("Accept-Encoding"));
+  bool gzip = asset.gzip && (encoding.indexOf(F("gzip")) >= 0);
+  String etag = FPSTR((asset.gzip && !gzip) ? asset.raw_etag : asset.etag);
+
   led_flash(LED_YEL);
 
-  if (p->session) p->session->update();
+  p->webserver->sendHeader(F("Cache-Control"), F("max-age=86400"));
+  p->webserver->sendHeader(F("ETag"), etag);
+
+  if (asset.gzip) {
+    p->webserver->sendHeader(F("Vary"), F("Accept-Encoding"));
+  }
+
+  // the browser's cached copy is still valid
+  if (p->webserver->header(F("If-None-Match")) == etag) {
+    p->webserver->send(304, String(), String());
+
+    return;
+  }
+
+  if (gzip) {
+    p->webserver->sendHeader(F("Content-Encoding"), F("gzip"));
+  }
+
+  // curl, wget and the like get it inflated on the fly
+  if (asset.gzip && !gzip) {
+    p->webserver->setContentLength(asset.raw_length);
+    p->webserver->send(200, FPSTR(asset.type), String());
 
-  p->webserver->sendContent(html);
+    p->webserver->produce(produce_asset);
+  } else {
+    p->webserver->send_P(200, asset.type, (PGM_P)asset.data, asset.length);
+  }
 
 #ifdef LOG_PAGE_SIZE
-  log_print(F("HTTP: serving chunk -> %i bytes"), html.length());
+  log_print(F("HTTP: serving asset (flash) -> %i bytes"), asset.length);
 #endif
-
-  // reset buffer
-  html = "";
 }
 
 static void send_page_header(bool menu = true) {
+  led_flash(LED_YEL);
+
+  // the page is rendered straight into the connection, see httpd.cpp
   p->webserver->setContentLength(CONTENT_LENGTH_UNKNOWN);
   p->webserver->send(200, F("text/html"), String());
 
-  html_insert_page_header(html);
-  html_insert_page_body(html, menu);
-
-  send_page_chunk(html);
+  html_insert_page_header(*p->webserver);
+  html_insert_page_body(*p->webserver, menu);
 }
 
 static void send_page_footer(void) {
-  html_insert_page_footer(html);
+  html_insert_page_footer(*p->webserver);
+}
+
+static void send_redirect(const String &redirect) {
+  led_flash(LED_YEL);
+
+  p->webserver->sendHeader(F("Location"), redirect);
+  p->webserver->sendHeader(F("Cache-Control"), F("no-cache"));
+  p->webserver->send(301, String(), String());
+}
+
+static void send_auth(const String &key, const String &redirect) {
+  String cookie = F("GENESYS_SESSION_KEY=");
+
+  cookie += key;
 
-  send_page_chunk(html);
-  p->webserver->sendContent(""); // end of chunked page
+  p->webserver->sendHeader(F("Set-Cookie"), cookie);
 
-  // free buffer
-  html = String();
+  send_redirect(redirect);
 }
 
 static bool setup_complete(void) {
@@ -229,52 +375,46 @@ static bool setup_complete(void) {
     return (true);
   }
 
-  html += F("HTTP/1.1 301 OK\n");
-  html += F("Location: /setup?init=1\n");
-  html += F("Cache-Control: no-cache\n\n");
-
-  send_page_chunk(html);
+  send_redirect(F("/setup?init=1"));
 
   return (false);
 }
 
 static bool authenticated(void) {
-  if (p->webserver->hasHeader(F("Cookie"))) {
-    String cookie = p->webserver->header(F("Cookie"));
-    String name = F("GENESYS_SESSION_KEY=");
-
-    if (!p->session) {
-      p->session = new Session();
-    }
+  Session *s = session_find();
 
-    if (cookie.indexOf(name + p->session->key) != -1) {
-      p->ota_enabled = true;
-      return (true);
-    }
+  if (s) {
+    session_update(s);
 
-    delete (p->session);
-    p->session = NULL;
+    return (true);
   }
 
-  html += F("HTTP/1.1 301 OK\n");
-  html += F("Location: /login\n");
-  html += F("Cache-Control: no-cache\n\n");
-
-  send_page_chunk(html);
+  send_redirect(F("/login"));
 
   return (false);
 }
 
+// OTA needs the session of a logged in user, except in ALPHA builds
+static bool ota_permitted(void) {
+#ifdef ALPHA
+  return (true);
+#else
+  return (session_find() != NULL);
+#endif
+}
+
 static void set_request_origin(void) {
   bool connected_via_softap = true;
 
-  IPAddress client_ip = p->webserver->client().remoteIP();
+  IPAddress client_ip = p->webserver->remoteIP();
   IPAddress softap_ip(p->ap_addr);
 
   for (int i=0; i<3; i++) {
     if (client_ip[i] != softap_ip[i]) connected_via_softap = false;
   }
 
+  p->via_softap = connected_via_softap;
+
   if (connected_via_softap) {
     html_client_connected_via_softap();
   } else {
@@ -282,27 +422,75 @@ static void set_request_origin(void) {
   }
 }
 
-static void send_auth(const String &key, const String &redirect) {
-  html += F("HTTP/1.1 301 OK\n");
-  html += F("Set-Cookie: GENESYS_SESSION_KEY=");
-  html += key;
-  html += F("\n");
-  html += F("Location: ");
-  html += redirect;
-  html += F("\n");
-  html += F("Cache-Control: no-cache\n\n");
+// the page header and body take the first steps of a page producer.
+// returns false until they are sent, step then counts from the content
+static bool page_head(int &step, bool menu = true) {
+  // other requests may have been served since the last step
+  set_request_origin();
 
-  send_page_chunk(html);
+  if (step == 0) html_insert_page_header(*p->webserver);
+  if (step == 1) html_insert_page_body(*p->webserver, menu);
+
+  step -= PAGE_HEAD_STEPS;
+
+  return (step >= 0);
 }
 
-static void send_redirect(const String &redirect) {
-  html += F("HTTP/1.1 301 OK\n");
-  html += F("Location: ");
-  html += redirect;
-  html += F("\n");
-  html += F("Cache-Control: no-cache\n\n");
+// a page is produced in steps, so only one step at a time is buffered
+static void send_page(HTTPProducer fn, int arg = 0) {
+  led_flash(LED_YEL);
+
+  p->webserver->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  p->webserver->send(200, F("text/html"), String());
 
-  send_page_chunk(html);
+  p->webserver->produce(fn, arg);
+}
+
+static uint32_t file_hash(File &file, size_t pos, uint32_t hash) {
+  uint8_t buf[64];
+  size_t len;
+
+  file.seek(pos, SeekSet);
+  len = file.read(buf, sizeof (buf));
+
+  // FNV-1a
+  for (size_t n=0; n<len; n++) hash = (hash ^ buf[n]) * 16777619;
+
+  return (hash);
+}
+
+// SPIFFS keeps no modification time, so the etag is made from the size
+// and a hash of both ends of the file. appending to a file (the usual
+// case for logs and stored samples) always changes it
+static String file_etag(File &file) {
+  uint32_t hash = 2166136261;
+  size_t size = file.size();
+  char etag[24];
+
+  hash = file_hash(file, 0, hash);
+  if (size > 64) hash = file_hash(file, size - 64, hash);
+
+  file.seek(0, SeekSet);
+
+  snprintf_P(etag, sizeof (etag), PSTR("\"%x-%08x\""), size, hash);
+
+  return (etag);
+}
+
+// the websocket host in the pages depends on the request origin
+static String cache_key(void) {
+  String key = p->webserver->uri();
+
+  for (int i=0; i<p->webserver->args(); i++) {
+    key += (i) ? '&' : '?';
+    key += p->webserver->argName(i);
+    key += '=';
+    key += p->webserver->arg(i);
+  }
+
+  if (p->via_softap) key += F("#ap");
+
+  return (key);
 }
 
 static void handle_file_action_cb(void) {
@@ -331,6 +519,7 @@ static void handle_file_action_cb(void) {
     if (p->webserver->uri() == F("/delete")) {
       log_print(F("HTTP: deleting file '%s'"), path.c_str());
       rootfs->remove(path);
+      cache_invalidate(CACHE_TAG_FILES);
       send_redirect(F("/files"));
 
       return;
@@ -352,68 +541,239 @@ static void handle_file_action_cb(void) {
     led_flash(LED_YEL);
 
     File file = rootfs->open(path, "r");
-    p->webserver->streamFile(file, get_content_type(path));
-    file.close();
+    // the file is closed by the server when it has been sent
+    p->webserver->streamFile(file, get_content_type(path), file_etag(file));
   } else {
     log_print(F("HTTP: file not found: %s"), path.c_str());
     p->webserver->send(404, F("text/plain"), F("FILE NOT FOUND"));
   }
 }
 
+static bool produce_csv(int step, int block) {
+  if (step == 0) storage_csv_header(*p->webserver);
+
+  // one block per step, the next step is run once the block is sent
+  return (storage_csv_block(*p->webserver, block + step));
+}
+
+static void handle_csv_cb(void) {
+  int block = 0;
+  char buf[64];
+
+  if (!setup_complete()) return;
+  if (!authenticated()) return;
+
+  // the samples from the block holding the from time (unix time) on
+  if (p->webserver->hasArg(F("from"))) {
+    block = storage_find(p->webserver->arg(F("from")).toInt());
+  }
+
+  snprintf_P(buf, sizeof (buf), PSTR("inline; filename=\"%s.csv\""),
+    system_device_name().c_str()
+  );
+  p->webserver->sendHeader(F("Content-Disposition"), buf);
+
+  led_flash(LED_YEL);
+
+  p->webserver->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  p->webserver->send(200, F("text/plain"), String());
+
+  p->webserver->produce(produce_csv, block);
+}
+
+static void upload_write(const uint8_t *data, size_t len) {
+  if (fs_upload->failed) return;
+
+  if (fs_upload->file.write(data, len) != len) {
+    log_print(F("HTTP: write failed, filesystem full?"));
+
+    fs_upload->failed = true;
+  }
+
+  fs_upload->written += len;
+}
+
+// only whole pages go to SPIFFS, the rest waits for the next chunk
+static void upload_append(const uint8_t *data, size_t len) {
+  fs_upload->crc = crc32_update(fs_upload->crc, data, len);
+
+  if (fs_upload->fill) {
+    size_t n = min(len, UPLOAD_PAGE_SIZE - fs_upload->fill);
+
+    memcpy(fs_upload->page + fs_upload->fill, data, n);
+    fs_upload->fill += n;
+    data += n;
+    len -= n;
+
+    if (fs_upload->fill < UPLOAD_PAGE_SIZE) return;
+
+    upload_write(fs_upload->page, UPLOAD_PAGE_SIZE);
+    fs_upload->fill = 0;
+  }
+
+  size_t whole = len - (len % UPLOAD_PAGE_SIZE);
+
+  if (whole) upload_write(data, whole);
+
+  memcpy(fs_upload->page, data + whole, len - whole);
+  fs_upload->fill = len - whole;
+}
+
+static void upload_finish(bool complete) {
+  if (complete && fs_upload->fill) {
+    upload_write(fs_upload->page, fs_upload->fill);
+  }
+
+  fs_upload->file.close();
+  fs_upload->finished = true;
+
+  // never leave a half written file behind
+  if (!complete || fs_upload->failed) {
+    log_print(F("HTTP: removing incomplete upload '%s'"),
+      fs_upload->path.c_str()
+    );
+
+    rootfs->remove(fs_upload->path);
+  } else {
+    log_print(F("HTTP: uploaded %i bytes (crc32 %08x)"),
+      fs_upload->written, fs_upload->crc
+    );
+  }
+
+  cache_invalidate(CACHE_TAG_FILES);
+}
+
+static bool upload_owned(void) {
+  if (!fs_upload || !p->webserver->hasUpload()) return (false);
+
+  return (fs_upload->owner == &p->webserver->upload());
+}
+
 static void handle_file_upload_done_cb(void) {
+  if (upload_owned()) {
+    char crc[12];
+
+    if (fs_upload->failed) {
+      p->webserver->send(507, F("text/plain"), F("UPLOAD FAILED"));
+    } else {
+      snprintf_P(crc, sizeof (crc), PSTR("%08x"), fs_upload->crc);
+
+      // lets scripts check the upload without reading the file back
+      p->webserver->sendHeader(F("X-Upload-CRC32"), crc);
+      p->webserver->sendHeader(F("X-Upload-Size"), String(fs_upload->written));
+
+      send_redirect(F("/files"));
+    }
+
+    delete (fs_upload);
+    fs_upload = NULL;
+
+    return;
+  }
+
   send_redirect(F("/files"));
 }
 
 static void handle_file_upload_cb(void) {
   HTTPUpload &upload = p->webserver->upload();
 
-  if (upload.status == UPLOAD_FILE_START){
-    String filename = upload.filename;
+  if (upload.status == UPLOAD_FILE_START) {
+    int total, used, unused = 0;
 
-    if (rootfs) {
-      fs_upload_file = rootfs->open(filename, "w");
+    // the chunks of two uploads cannot go into one FileUpload
+    if (fs_upload && !fs_upload->finished) {
+      log_print(F("HTTP: another upload is in progress"));
+      p->webserver->send(503, F("text/plain"), F("UPLOAD IN PROGRESS"));
 
-      log_print(F("HTTP: uploading file '%s'"), filename.c_str());
+      return;
+    }
 
-      if (!fs_upload_file) {
-        log_print(F("HTTP: could not open file for writing"));
-      }
-    } else {
+    // left behind by a connection that closed before its response
+    delete (fs_upload);
+    fs_upload = NULL;
+
+    if (!rootfs) {
       log_print(F("HTTP: filesytem not mounted"));
+
+      return;
     }
-  } else if (upload.status == UPLOAD_FILE_WRITE) {
-    if (fs_upload_file) {
-      fs_upload_file.write(upload.buf, upload.currentSize);
+
+    fs_usage(total, used, unused);
+
+    // the body includes the multipart framing, so this errs on the safe side
+    if (p->webserver->contentLength() > (size_t)unused) {
+      log_print(F("HTTP: upload of %i bytes does not fit (%i bytes free)"),
+        p->webserver->contentLength(), unused
+      );
+      p->webserver->send(413, F("text/plain"), F("NOT ENOUGH SPACE"));
+
+      return;
     }
-  } else if (upload.status == UPLOAD_FILE_END) {
-    if (fs_upload_file) {
-      fs_upload_file.close();
 
-      log_print(F("HTTP: uploaded %i bytes"), upload.totalSize);
+    fs_upload = new FileUpload();
+    fs_upload->owner    = &upload;
+    fs_upload->path     = upload.filename;
+    fs_upload->crc      = 0;
+    fs_upload->written  = 0;
+    fs_upload->failed   = false;
+    fs_upload->finished = false;
+    fs_upload->fill     = 0;
+    fs_upload->file    = rootfs->open(upload.filename, "w");
+
+    log_print(F("HTTP: uploading file '%s'"), upload.filename.c_str());
+
+    if (!fs_upload->file) {
+      log_print(F("HTTP: could not open file for writing"));
+
+      fs_upload->failed = true;
     }
+  } else if (!upload_owned() || fs_upload->finished) {
+    return;
+  } else if (upload.status == UPLOAD_FILE_WRITE) {
+    upload_append(upload.buf, upload.currentSize);
+  } else if (upload.status == UPLOAD_FILE_END) {
+    upload_finish(true);
+  } else if (upload.status == UPLOAD_FILE_ABORTED) {
+    upload_finish(false);
+
+    delete (fs_upload);
+    fs_upload = NULL;
   }
 }
 
-static void handle_file_page_cb(void) {
-  String path;
+static bool produce_file_page(int step, int arg) {
+  String path, key;
 
-  if (!setup_complete()) return;
-  if (!authenticated()) return;
-
-  set_request_origin();
+  if (!page_head(step)) return (true);
 
   if (p->webserver->hasArg(F("path"))) {
     path = p->webserver->arg(F("path"));
   }
 
-  send_page_header();
-  html_insert_file_content(html, path);
-  send_page_chunk(html);
+  key = cache_key();
+
+  if (!cache_send(*p->webserver, key)) {
+    CacheWriter out(*p->webserver, key, CACHE_TTL_FILES,
+      CACHE_TAG_FILES
+    );
+
+    html_insert_file_content(out, path);
+  }
+
   send_page_footer();
+
+  return (false);
+}
+
+static void handle_file_page_cb(void) {
+  if (!setup_complete()) return;
+  if (!authenticated()) return;
+
+  send_page(produce_file_page);
 }
 
 static void handle_update_start_cb(void) {
-  if (!p->ota_enabled) {
+  if (!ota_permitted()) {
     p->webserver->send(403, F("text/plain"), F("Login before OTA update ..."));
 
     return;
@@ -442,65 +802,63 @@ static void handle_update_start_cb(void) {
 }
 
 static void handle_update_finished_cb(void) {
-  if (!p->ota_enabled) {
+  bool ours = p->webserver->hasUpload() && (&p->webserver->upload() == ota_upload);
+
+  // the image was accepted at its start, a session that expired while
+  // it was uploading doesn't matter anymore
+  if (ours) {
+    ota_upload = NULL;
+  } else if (!ota_permitted()) {
     p->webserver->send(403, F("text/plain"), F("Login before OTA update ..."));
 
     return;
   }
 
-  html += F("Update ");
-  html += (Update.hasError()) ? F("FAILED") : F("OK");
-  html += F("!\nRebooting ...\n\n");
+  String msg = F("Update ");
 
-  trigger_reboot(2000);
-
-  p->webserver->send(200, F("text/plain"), html);
-
-  html = "";
-}
-
-static void handle_update_error(void) {
-  StreamString out;
-  String err;
-
-  Update.printError(out);
-  err = out.readString();
-  err.replace("\r", "");
-  err.replace("\n", "");
+  msg += (ota_failed()) ? F("FAILED") : F("OK");
+  msg += F("!\nRebooting ...\n\n");
 
-  log_print(err.c_str());
+  trigger_reboot(2000);
 
-  led_off(LED_GRN);
+  p->webserver->send(200, F("text/plain"), msg);
 }
 
 static void handle_update_progress_cb(void) {
   uint32_t free_space = (system_free_sketch_space() - 0x1000) & 0xFFFFF000;
   HTTPUpload &upload = p->webserver->upload();
-  static int received = 0, last_perc = -1;
-  StreamString out;
+  static int last_perc = -1;
 
-  if (!p->ota_enabled) {
-    p->webserver->send(403, F("text/plain"), F("Login before OTA update ..."));
+  if (upload.status == UPLOAD_FILE_START){
+    // refused once, the chunks that follow don't belong to ota_upload
+    if (!ota_permitted()) {
+      p->webserver->send(403, F("text/plain"), F("Login before OTA update ..."));
 
-    return;
-  }
+      return;
+    }
 
-  if (upload.status == UPLOAD_FILE_START){
     log_print(F("HTTP: available space: %u bytes"), free_space);
     log_print(F("HTTP: filename: %s"), upload.filename.c_str());
 
-    if (!Update.begin(free_space)) {
-      handle_update_error();
+    // raw and packed (ota.pl) images are both accepted, but only one at a
+    // time. a pull download is stopped by GET /update beforehand
+    if (!ota_begin(free_space)) {
+      log_print(F("HTTP: another update is in progress"));
+      p->webserver->send(503, F("text/plain"), F("UPDATE IN PROGRESS"));
+
+      return;
     }
 
+    ota_upload = &upload;
+
     led_off(LED_GRN);
+  } else if (&upload != ota_upload) {
+    return;
   } else if (upload.status == UPLOAD_FILE_WRITE) {
-    if (Update.write(upload.buf, upload.currentSize) != upload.currentSize) {
-      handle_update_error();
+    if (ota_write(upload.buf, upload.currentSize) != upload.currentSize) {
+      led_off(LED_GRN);
     } else {
-      received += upload.currentSize;
-
-      int perc = 100 * received / system_sketch_size();
+      int perc = ota_progress();
 
       if (perc != last_perc) {
         log_progress(F("HTTP: received "), "%", perc);
@@ -510,61 +868,133 @@ static void handle_update_progress_cb(void) {
       led_toggle(LED_GRN);
     }
   } else if (upload.status == UPLOAD_FILE_END) {
-    if (Update.end(true)) { // true to set the size to the current progress
+    if (ota_end()) {
       log_print(F("HTTP: update successful: %u bytes"), upload.totalSize);
 
       led_on(LED_GRN);
     } else {
-      handle_update_error();
+      led_off(LED_GRN);
     }
+
+    // cleared by handle_update_finished_cb() that answers this upload
+  } else if (upload.status == UPLOAD_FILE_ABORTED) {
+    ota_abort();
+
+    ota_upload = NULL;
+
+    led_off(LED_GRN);
   }
 }
 
+static bool produce_info_page(int step, int arg) {
+  String key;
+
+  if (!page_head(step)) return (true);
+
+  // each part is cached on its own
+  key = cache_key();
+  key += '#';
+  key += step;
+
+  if (!cache_send(*p->webserver, key)) {
+    CacheWriter out(*p->webserver, key, CACHE_TTL_INFO,
+      CACHE_TAG_CONFIG | CACHE_TAG_WIFI
+    );
+
+    html_insert_info_content(out, step);
+  }
+
+  if (step < INFO_PARTS - 1) return (true);
+
+  send_page_footer();
+
+  return (false);
+}
+
 static void handle_info_cb(void) {
   if (!setup_complete()) return;
   if (!authenticated()) return;
 
-  set_request_origin();
+  send_page(produce_info_page);
+}
+
+// pages with one step of content
+static bool produce_page(int step, int page) {
+  HTTPServer &out = *p->webserver;
+
+  if (!page_head(step, page != PAGE_LOGIN)) return (true);
+
+       if (page == PAGE_ROOT)  html_insert_root_content(out);
+  else if (page == PAGE_CLOCK) html_insert_clock_content(out);
+  else if (page == PAGE_LOG)   html_insert_log_content(out);
+  else if (page == PAGE_LOGIN) {
+    String msg = F("Enter username and password!");
+
+    // the handler has already redirected a successful login
+    if (out.hasArg(F("USER")) && out.hasArg(F("PASS"))) {
+      msg = F("Login failed, try again!\n");
+    }
+
+    html_insert_login_content(out, msg);
+  }
 
-  send_page_header();
-  html_insert_info_content(html);
-  send_page_chunk(html);
   send_page_footer();
+
+  return (false);
+}
+
+static bool produce_wifi_scan(int step, int arg) {
+  // the scan runs in the background, check back on the next poll
+  if (net_scan_running()) return (true);
+
+  p->webserver->print(F("["));
+  html_insert_wifi_list(*p->webserver);
+  p->webserver->print(F("]\n\n"));
+
+  return (false);
 }
 
 static void handle_wifi_scan_cb(void) {
-  net_scan_wifi();
+  // a fresh enough result is sent right away
+  if (net_scan_age() > WIFI_SCAN_MAX_AGE) net_scan_wifi();
 
-  html += F("[");
-  html_insert_wifi_list(html);
-  html += F("]\n\n");
+  p->webserver->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  p->webserver->send(200, F("text/plain"), String());
 
-  send_page(html, F("text/plain"));
+  p->webserver->produce(produce_wifi_scan);
 }
 
 #ifdef ALPHA
-static void handle_sys_cb(void) {
-  if (!setup_complete()) return;
-  if (!authenticated()) return;
+static bool produce_sys_page(int step, int arg) {
+  int row;
 
-  set_request_origin();
+  // one chunk per step, the next step is run once the chunk is sent
+  if (!page_head(step)) return (true);
+
+  row = step - 1;
+
+  if (step == 0) {
+    html_insert_module_header(*p->webserver);
+  } else if (row < module_count()) {
+    html_insert_module_row(*p->webserver, row);
+  } else {
+    html_insert_module_footer(*p->webserver);
 
-  send_page_header();
+    // rest of sys page
+    html_insert_sys_content(*p->webserver);
+    send_page_footer();
 
-  // send modules
-  html_insert_module_header(html);
-  send_page_chunk(html);
-  for (int i=0; i<module_count(); i++) {
-    html_insert_module_row(html, i);
-    send_page_chunk(html);
+    return (false);
   }
-  html_insert_module_footer(html);
-  send_page_chunk(html);
 
-  // rest of sys page
-  html_insert_sys_content(html);
-  send_page_chunk(html);
-  send_page_footer();
+  return (true);
+}
+
+static void handle_sys_cb(void) {
+  if (!setup_complete()) return;
+  if (!authenticated()) return;
+
+  send_page(produce_sys_page);
 }
 #endif
 
@@ -573,14 +1003,7 @@ static void handle_log_cb(void) {
   if (!setup_complete()) return;
   if (!authenticated()) return;
 
-  set_request_origin();
-
-  send_page_header();
-
-  // rest of sys page
-  html_insert_log_content(html);
-  send_page_chunk(html);
-  send_page_footer();
+  send_page(produce_page, PAGE_LOG);
 }
 #endif
 
@@ -603,11 +1026,11 @@ static bool config_parse(String &str) {
     str += F("<br /><b>WiFI is disabled.</b>\n");
     if (!config->storage_enabled) {
       str += F("<br /><b>Enabling local storage.</b>\n");
-      config->storage_enabled = 1;
+      config_set(F("storage_enabled"), F("1"));
     }
     if (!config->ap_enabled) {
       str += F("<br /><b>Enabling local AP.</b>\n");
-      config->ap_enabled = 1;
+      config_set(F("ap_enabled"), F("1"));
     }
     str += F("<br />\n");
   }
@@ -615,78 +1038,81 @@ static bool config_parse(String &str) {
   return (config_ok);
 }
 
-static void handle_conf_cb(void) {
-  bool conf = (p->webserver->uri() == F("/conf"));
-  bool menu = true;
-
-  if (!setup_complete()) return;
-  if (!authenticated()) return;
+static const uint8_t setup_sections[] = {
+  CONF_HEADER,
+  CONF_USER,
+  CONF_DEVICE,
+  CONF_WIFI,
+  CONF_IP,
+  CONF_FOOTER
+};
 
-  set_request_origin();
+static const uint8_t conf_sections[] = {
+  CONF_HEADER,
+  CONF_AP,
+  CONF_NTP,
+  CONF_TELEMETRY,
+  CONF_STORAGE,
+  CONF_MDNS,
+  CONF_UPDATE,
+  CONF_LOGGER,
+  CONF_FOOTER
+};
 
-  if (p->webserver->hasArg(F("init"))) menu = false;
+static bool produce_conf_page(int step, int conf) {
+  const uint8_t *section = (conf) ? conf_sections : setup_sections;
+  int count = (conf) ? sizeof (conf_sections) : sizeof (setup_sections);
+  bool menu = !p->webserver->hasArg(F("init"));
 
-  send_page_header(menu);
+  // one section per step, the next step is run once the section is sent
+  if (!page_head(step, menu)) return (true);
 
   config_init();
+  html_insert_conf_content(*p->webserver, section[step]);
+  config_fini();
 
-  if (p->webserver->method() == HTTP_GET) {
-    html_insert_conf_content(html, CONF_HEADER);
-    send_page_chunk(html);
-
-    if (!conf) {
-      // [SETUP]
+  if (step < count - 1) return (true);
 
-      html_insert_conf_content(html, CONF_USER);
-      send_page_chunk(html);
+  send_page_footer();
 
-      html_insert_conf_content(html, CONF_DEVICE);
-      send_page_chunk(html);
+  return (false);
+}
 
-      html_insert_conf_content(html, CONF_WIFI);
-      send_page_chunk(html);
+static void handle_conf_cb(void) {
+  bool conf = (p->webserver->uri() == F("/conf"));
+  bool menu = true;
 
-      html_insert_conf_content(html, CONF_IP);
-      send_page_chunk(html);
-    } else {
-      // [CONF]
+  if (!setup_complete()) return;
+  if (!authenticated()) return;
 
-      html_insert_conf_content(html, CONF_AP);
-      send_page_chunk(html);
+  if (p->webserver->method() == HTTP_GET) {
+    // [CONF] or [SETUP]
+    send_page(produce_conf_page, conf);
 
-      html_insert_conf_content(html, CONF_NTP);
-      send_page_chunk(html);
+    return;
+  }
 
-      html_insert_conf_content(html, CONF_TELEMETRY);
-      send_page_chunk(html);
+  // saving reboots the device, so this short page is sent at once
+  set_request_origin();
 
-      html_insert_conf_content(html, CONF_STORAGE);
-      send_page_chunk(html);
+  if (p->webserver->hasArg(F("init"))) menu = false;
 
-      html_insert_conf_content(html, CONF_MDNS);
-      send_page_chunk(html);
+  send_page_header(menu);
 
-      html_insert_conf_content(html, CONF_UPDATE);
-      send_page_chunk(html);
+  String msg;
 
-      html_insert_conf_content(html, CONF_LOGGER);
-      send_page_chunk(html);
-    }
+  config_init();
 
-    html_insert_conf_content(html, CONF_FOOTER);
-    send_page_chunk(html);
+  if (config_parse(msg)) {
+    trigger_reboot(2000);
   } else {
-    if (config_parse(html)) {
-      trigger_reboot(2000);
-    } else {
-      trigger_reboot(20000);
-    }
-    config_write();
-
-    html += F("<br />Config saved.\n");
-    html_insert_websocket_script(html);
-    send_page_chunk(html);
+    trigger_reboot(20000);
   }
+  config_write();
+
+  p->webserver->print(msg);
+  p->webserver->print(F("<br />Config saved.\n"));
+  html_insert_websocket_script(*p->webserver);
 
   config_fini();
 
@@ -699,140 +1125,161 @@ static void handle_login_cb(void) {
   set_request_origin();
 
   if (p->webserver->hasArg(F("LOGOUT"))) {
-    send_auth(F("0"), F("/login"));
+    Session *s = session_find();
 
-    delete (p->session);
-    p->session = NULL;
+    if (s) session_close(s);
 
-#ifdef RELEASE
-    p->ota_enabled = false;
-#endif
+    send_auth(F("0"), F("/login"));
 
     return;
   }
 
-  String msg = F("Enter username and password!");
-
   if (p->webserver->hasArg(F("USER")) && p->webserver->hasArg(F("PASS"))) {
     if (p->webserver->arg(F("USER")) == p->user) {
       if (p->webserver->arg(F("PASS")) == p->pass) {
-        if (!p->session) {
-          p->session = new Session();
+        Session *s = session_find();
+
+        // a browser logging in again keeps its session
+        if (s) {
+          session_update(s);
+        } else {
+          s = session_create();
         }
 
-        send_auth(p->session->key, F("/"));
+        send_auth(s->key, F("/"));
 
         return;
       }
     }
 
-    msg = F("Login failed, try again!\n");
     log_print(F("HTTP: login failed"));
   }
 
-  send_page_header(false); // false = no menu
-  html_insert_login_content(html, msg);
-  send_page_chunk(html);
-  send_page_footer();
+  send_page(produce_page, PAGE_LOGIN); // no menu
 }
 
 static void handle_root_cb(void) {
   if (!setup_complete()) return;
   if (!authenticated()) return;
 
-  set_request_origin();
-
-  send_page_header();
-  html_insert_root_content(html);
-  send_page_chunk(html);
-  send_page_footer();
+  send_page(produce_page, PAGE_ROOT);
 }
 
 static void handle_clock_cb(void) {
   if (!setup_complete()) return;
   if (!authenticated()) return;
 
-  set_request_origin();
-
-  send_page_header();
-  html_insert_clock_content(html);
-  send_page_chunk(html);
-  send_page_footer();
+  send_page(produce_page, PAGE_CLOCK);
 }
 
-static void handle_style_css_cb(void) {
-  send_page_P(html_page_style_css, text_css_str);
-}
+static void handle_asset_cb(void) {
+  Asset asset;
 
-static void handle_config_js_cb(void) {
-  send_page_P(html_page_config_js, text_javascript_str);
+  if (asset_find(p->webserver->uri(), asset)) {
+    send_asset(asset);
+  } else {
+    p->webserver->send(404, F("text/plain"), F("NOT FOUND"));
+  }
 }
 
-static void handle_common_js_cb(void) {
-  send_page_P(html_page_common_js, text_javascript_str);
-}
+static bool produce_api(int step, int arg) {
+  const String &uri = p->webserver->uri();
+  String fields = p->webserver->arg(F("fields"));
+  String key;
+  bool more;
 
-static void handle_root_js_cb(void) {
-  send_page_P(html_page_root_js,  text_javascript_str);
-}
+  if (step > 0) return (api_render(*p->webserver, uri, fields, step));
 
-static void handle_clock_js_cb(void) {
-  send_page_P(html_page_clock_js,  text_javascript_str);
-}
+  key = cache_key();
 
-static void handle_logo_js_cb(void) {
-  send_page_P(html_page_logo_js,   text_javascript_str);
-}
+  if (cache_send(*p->webserver, key)) return (false);
 
-static void handle_sys_js_cb(void) {
-  send_page_P(html_page_sys_js,    text_javascript_str);
+  CacheWriter out(*p->webserver, key, CACHE_TTL_API, CACHE_TAG_ALL);
+
+  more = api_render(out, uri, fields);
+
+  // only a response that is rendered in one step is cached
+  if (more) out.discard();
+
+  return (more);
 }
 
-static void handle_favicon_cb(void) {
-  send_page_P(fav_png,  image_png_str, fav_len);
+static void handle_api_cb(void) {
+  Session *s = session_find();
+
+  // no redirect to /login here, API clients want a status code and a
+  // hint where the session cookie comes from
+  if (!s) {
+    p->webserver->sendHeader(F("WWW-Authenticate"),
+      F("Cookie realm=\"genesys\", form-action=\"/login\", "
+        "cookie-name=\"GENESYS_SESSION_KEY\"")
+    );
+    p->webserver->send(401, F("application/json"), F("{}\n"));
+
+    return;
+  }
+
+  session_update(s);
+
+  p->webserver->sendHeader(F("Cache-Control"), F("no-cache"));
+  p->webserver->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  p->webserver->send(200, F("application/json"), String());
+
+  p->webserver->produce(produce_api);
 }
 
-static void handle_saveicon_cb(void) {
-  send_page_P(save_png, image_png_str, save_len);
+static bool produce_metrics(int step, int arg) {
+  return (metrics_render(*p->webserver, step));
 }
 
-static void handle_viewicon_cb(void) {
-  send_page_P(view_png, image_png_str, view_len);
+static void handle_metrics_cb(void) {
+  // no session, scrapers cannot log in
+  p->webserver->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  p->webserver->send(200, F("text/plain; version=0.0.4"), String());
+
+  p->webserver->produce(produce_metrics);
 }
 
-static void handle_delicon_cb(void) {
-  send_page_P(del_png,  image_png_str, del_len);
+#ifdef ALPHA
+static bool produce_404_page(int step, int arg) {
+  HTTPServer &out = *p->webserver;
+
+  if (!page_head(step)) return (true);
+
+  out.print(F("<h3>404 File Not Found</h3>\n"));
+  out.print(F("<p>\n"));
+  out.print(F("URI: "));
+  out.print(out.uri());
+  out.print(F("<br />\nMethod: "));
+  out.print((out.method() == HTTP_GET) ? F("GET") : F("POST"));
+  out.print(F("<br />\nArguments: "));
+  out.print(out.args());
+  out.print(F("<br />\n"));
+
+  for (uint8_t i = 0; i < out.args(); i++) {
+    out.print(F(" "));
+    out.print(out.argName(i));
+    out.print(F(": "));
+    out.print(out.arg(i));
+    out.print(F("<br />\n"));
+  }
+
+  out.print(F("</p>\n"));
+
+  html_insert_page_footer(out);
+
+  return (false);
 }
+#endif
 
 static void handle_404_cb(void) {
 #ifndef ALPHA
   send_redirect(F("/"));
 #else
-  html_insert_page_header(html);
-  html_insert_page_body(html);
-
-  html += F("<h3>404 File Not Found</h3>\n");
-  html += F("<p>\n");
-  html += F("URI: ");
-  html += p->webserver->uri();
-  html += F("<br />\nMethod: ");
-  html += (p->webserver->method() == HTTP_GET) ? F("GET") : F("POST");
-  html += F("<br />\nArguments: ");
-  html += p->webserver->args();
-  html += F("<br />\n");
-
-  for (uint8_t i = 0; i < p->webserver->args(); i++) {
-    html += F(" ");
-    html += p->webserver->argName(i);
-    html += F(": ");
-    html += p->webserver->arg(i);
-    html += F("<br />\n");
-  }
-
-  html += F("</p>\n");
-
-  html_insert_page_footer(html);
-  send_page(html, F("text/html"), 404);
+  p->webserver->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  p->webserver->send(404, F("text/html"), String());
+
+  p->webserver->produce(produce_404_page);
 #endif
 }
 
@@ -864,10 +1311,6 @@ bool webserver_init(void) {
   p = (HTTP_PrivateData *)malloc(sizeof (HTTP_PrivateData));
   memset(p, 0, sizeof (HTTP_PrivateData));
 
-#ifdef ALPHA
-  p->ota_enabled = true;
-#endif
-
   if (config->ap_enabled) p->ap_addr = config->ap_addr;
 
   config_get(F("user_name"), str);
@@ -877,7 +1320,7 @@ bool webserver_init(void) {
 
   config_fini();
 
-  p->webserver = new ESP8266WebServer(80);
+  p->webserver = new HTTPServer(80);
 
   p->webserver->onNotFound(handle_404_cb);
 
@@ -896,18 +1339,18 @@ bool webserver_init(void) {
 #endif
   p->webserver->on(F("/scan"),      HTTP_GET,  handle_wifi_scan_cb);
 
-  p->webserver->on(F("/fav.png"),   HTTP_GET,  handle_favicon_cb);
-  p->webserver->on(F("/save.png"),  HTTP_GET,  handle_saveicon_cb);
-  p->webserver->on(F("/view.png"),  HTTP_GET,  handle_viewicon_cb);
-  p->webserver->on(F("/del.png"),   HTTP_GET,  handle_delicon_cb);
+  for (int i=0; i<assets_count(); i++) {
+    Asset asset;
+
+    asset_get(i, asset);
+    p->webserver->on(FPSTR(asset.uri), HTTP_GET, handle_asset_cb);
+  }
+
+  for (int i=0; i<api_count(); i++) {
+    p->webserver->on(FPSTR(api_uri(i)), HTTP_GET, handle_api_cb);
+  }
 
-  p->webserver->on(F("/style.css"), HTTP_GET,  handle_style_css_cb);
-  p->webserver->on(F("/config.js"), HTTP_GET,  handle_config_js_cb);
-  p->webserver->on(F("/common.js"), HTTP_GET,  handle_common_js_cb);
-  p->webserver->on(F("/clock.js"),  HTTP_GET,  handle_clock_js_cb);
-  p->webserver->on(F("/root.js"),   HTTP_GET,  handle_root_js_cb);
-  p->webserver->on(F("/logo.js"),   HTTP_GET,  handle_logo_js_cb);
-  p->webserver->on(F("/sys.js"),    HTTP_GET,  handle_sys_js_cb);
+  p->webserver->on(F("/metrics"),   HTTP_GET,  handle_metrics_cb);
 
   p->webserver->on(F("/update"),    HTTP_GET,  handle_update_start_cb);
   p->webserver->on(F("/update"),    HTTP_POST, handle_update_finished_cb,
@@ -917,28 +1360,26 @@ bool webserver_init(void) {
   p->webserver->on(F("/view"),      HTTP_GET,  handle_file_action_cb);
   p->webserver->on(F("/download"),  HTTP_GET,  handle_file_action_cb);
   p->webserver->on(F("/delete"),    HTTP_GET,  handle_file_action_cb);
+  p->webserver->on(F("/csv"),       HTTP_GET,  handle_csv_cb);
   p->webserver->on(F("/upload"),    HTTP_POST, handle_file_upload_done_cb,
                                                handle_file_upload_cb);
 
   // the list of headers to be recorded
   String h1 = F("User-Agent"), h2 = F("Cookie");
-  const char *headerkeys[] = { h1.c_str(), h2.c_str() };
+  String h3 = F("If-None-Match"), h4 = F("Accept-Encoding");
+  String h5 = F("Range"), h6 = F("If-Range");
+  const char *headerkeys[] = {
+    h1.c_str(), h2.c_str(), h3.c_str(), h4.c_str(), h5.c_str(), h6.c_str()
+  };
   size_t headerkeyssize = sizeof (headerkeys) / sizeof (char *);
 
   // ask server to track these headers
   p->webserver->collectHeaders(headerkeys, headerkeyssize);
 
-  if (!html.reserve(HTML_BUFFER_SIZE)) {
-    log_print(F("HTTP: failed to reserve %s for html buffer"),
-      fs_format_bytes(HTML_BUFFER_SIZE).c_str()
-    );
-  }
-
   at24c32_init();
-  icon_init();
   html_init();
 
-  p->session = Session::load();
+  session_load();
 
   p->webserver->begin();
 
@@ -950,10 +1391,17 @@ bool webserver_fini(void) {
 
   log_print(F("HTTP: shutting down webserver"));
 
-  html = String();
-
   delete (p->webserver);
-  delete (p->session);
+
+  delete (fs_upload);
+  fs_upload = NULL;
+
+  cache_clear();
+
+  // keep the sessions across a reboot
+  for (int i=0; i<SESSION_SLOTS; i++) {
+    if (p->session[i].expires) session_sync(&p->session[i], true);
+  }
 
   // free private p->data
   free(p);
@@ -965,7 +1413,9 @@ bool webserver_fini(void) {
 void webserver_poll(void) {
   if (!p) return;
 
-  p->webserver->handleClient();
+  p->webserver->poll();
+
+  cache_poll();
 
   if (p->delayed_reboot) {
     if (p->delayed_reboot == 1) {
@@ -976,17 +1426,10 @@ void webserver_poll(void) {
     }
   }
 
-  if (p->session && (system_utc() > p->session->expires)) {
-    log_print(F("HTTP: session timeout, force logout"));
-
-    delete (p->session);
-    p->session = NULL;
-
-#ifdef RELEASE
-    p->ota_enabled = false;
-#endif
+  if (millis() - p->last_sweep > SESSION_SWEEP) {
+    p->last_sweep = millis();
 
-    websocket_broadcast_message(F("logout"));
+    session_sweep();
   }
 }
 
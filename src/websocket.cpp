@@ -21,6 +21,7 @@
 
 #include <limits.h>
 
+#include "message.h"
 #include "logger.h"
 #include "system.h"
 #include "module.h"
@@ -50,7 +51,8 @@ enum {
   CLIENT_REQUEST_TIME,
   CLIENT_REQUEST_LOAD,
   CLIENT_REQUEST_LOG,
-  CLIENT_REQUEST_ADC
+  CLIENT_REQUEST_ADC,
+  CLIENT_REQUESTS
 };
 
 struct WS_PrivateData {
@@ -58,67 +60,54 @@ struct WS_PrivateData {
 
   WebSocketsServer *websocket = NULL;
 
-  uint32_t packet_reserved;
-  char packet_purpose[16];
-
   uint8_t module;
 };
 
 static WS_PrivateData *p = NULL;
 
-// global send buffer
-static String data;
-
-static void packet_prepare(uint32_t reserve, const char *purpose = NULL) {
-  strncpy_P(p->packet_purpose, purpose, sizeof (p->packet_purpose));
-  p->packet_reserved = reserve;
+static Message *packet_prepare(uint32_t reserve) {
+  // WEBSOCKETS_MAX_HEADER_SIZE bytes are reserved for the frame header
+  return (message_new(reserve, WEBSOCKETS_MAX_HEADER_SIZE));
+}
 
-  if (!data.reserve(reserve)) {
-    log_print(F("WS:   could not allocate %s buffer"), p->packet_purpose);
-  }
+static void packet_check(Message *msg, uint32_t reserve, const char *purpose) {
+  char buf[16];
 
-  data = F("              "); // 14 bytes reserved for header
-}
+  strncpy_P(buf, purpose, sizeof (buf));
 
-static void packet_check(void) {
-  if (data.length() >= p->packet_reserved) {
+  if (message_length(msg) >= reserve) {
     log_print(F("WS:   %s buffer too small (size=%i, need=%i)"),
-      p->packet_purpose, p->packet_reserved, data.length()
+      buf, reserve, message_length(msg)
     );
   }
 
 #ifdef LOG_BUFFER_USAGE
-  log_print(F("WS:   %s buffer = %i bytes"), p->packet_purpose, data.length());
+  log_print(F("WS:   %s buffer = %i bytes"), buf, message_length(msg));
 #endif
-
-  p->packet_purpose[0] = '\0';
-  p->packet_reserved = 0;
-
-  data = String();
 }
 
-static void packet_send(int client) {
-  int len = data.length() - WEBSOCKETS_MAX_HEADER_SIZE;
-
-  p->websocket->sendTXT(client, (char *)data.c_str(), len, true);
+static void packet_send(int client, Message *msg) {
+  // the frame header is written into the headroom of the message,
+  // since it only depends on the payload length, it is the same for
+  // every client and the message can be shared between all of them
 
-  packet_check();
+  p->websocket->sendTXT(client,
+    (char *)msg->data.c_str(), message_length(msg), true
+  );
 }
 
-static void packet_broadcast(void) {
-  int len = data.length() - WEBSOCKETS_MAX_HEADER_SIZE;
-
-  p->websocket->broadcastTXT((char *)data.c_str(), len, true);
-
-  packet_check();
+static void packet_broadcast(Message *msg) {
+  p->websocket->broadcastTXT(
+    (char *)msg->data.c_str(), message_length(msg), true
+  );
 }
 
-static void send_time_data(int client) {
+static Message *build_time_data(void) {
+  Message *msg = packet_prepare(150);
   char time[16], uptime[24];
+  String &data = msg->data;
   struct timespec tm;
 
-  packet_prepare(150, PSTR("TIME"));
-
   clock_gettime(CLOCK_REALTIME, &tm);
 
   data += F("{\"type\":\"time\",");
@@ -138,38 +127,45 @@ static void send_time_data(int client) {
   data += system_time(time);
   data += F("\"}");
 
-  packet_send(client);
+  packet_check(msg, 150, PSTR("TIME"));
+
+  return (msg);
 }
 
-static void send_adc_data(int client) {
-  packet_prepare(100, PSTR("ADC"));
+static Message *build_adc_data(void) {
+  Message *msg = packet_prepare(100);
+  String &data = msg->data;
 
   data += F("{\"type\":\"adc\",\"value\":");
   data += String(analogRead(17));
   data += F("}");
 
-  packet_send(client);
+  packet_check(msg, 100, PSTR("ADC"));
+
+  return (msg);
 }
 
-static void send_relais_data(int client) {
+static Message *build_relais_data(void) {
+  Message *msg = packet_prepare(100);
+  String &data = msg->data;
   bool state;
 
-  packet_prepare(100, PSTR("RELAIS"));
-
   gpio_relais_state(state);
 
   data += F("{\"type\":\"relais\",\"value\":");
   data += String(state);
   data += F("}");
 
-  packet_send(client);
+  packet_check(msg, 100, PSTR("RELAIS"));
+
+  return (msg);
 }
 
-static void send_load_data(int client) {
+static Message *build_load_data(void) {
 #ifdef ALPHA
   String cpu_data, mem_data, net_data;
-
-  packet_prepare(450, PSTR("LOAD"));
+  Message *msg = packet_prepare(450);
+  String &data = msg->data;
 
   for (int i=0; i<system_load_history_entries(); i++) {
     SysLoad load = system_load_history(i);
@@ -203,12 +199,17 @@ static void send_load_data(int client) {
   data += system_net_xfer();
   data += F("}}");
 
-  packet_send(client);
+  packet_check(msg, 450, PSTR("LOAD"));
+
+  return (msg);
+#else
+  return (NULL);
 #endif
 }
 
-static void send_module_data(int client) {
-  packet_prepare(300, PSTR("MODULE"));
+static Message *build_module_data(void) {
+  Message *msg = packet_prepare(300);
+  String &data = msg->data;
 
   data += F("{\"type\":\"module\",\"state\":[");
   for (int i=0; i<module_count(); i++) {
@@ -224,31 +225,50 @@ static void send_module_data(int client) {
   }
   data += F("]}");
 
-  packet_send(client);
+  packet_check(msg, 300, PSTR("MODULE"));
+
+  return (msg);
 }
 
-static void send_temp_data(int client) {
+static Message *build_temp_data(void) {
+  Message *msg = packet_prepare(100);
+  String &data = msg->data;
   float temp = rtc_temp();
 
-  packet_prepare(100, PSTR("TEMP"));
-
   data += F("{\"type\":\"temp\",");
 
   data += F("\"value\":\"");
   data += float2str(temp);
   data += F("\"}");
 
-  packet_send(client);
+  packet_check(msg, 100, PSTR("TEMP"));
+
+  return (msg);
 }
 
-static void send_log_data(int client) {
-  packet_prepare(4000, PSTR("LOG"));
+static Message *build_log_data(void) {
+  Message *msg = packet_prepare(4000);
+  String &data = msg->data;
 
   data += F("{\"type\":\"log\",\"text\":\"");
   logger_dump_html(data, -1);
   data += F("\"}");
 
-  packet_send(client);
+  packet_check(msg, 4000, PSTR("LOG"));
+
+  return (msg);
+}
+
+static Message *build_message(int req) {
+  if (req == CLIENT_REQUEST_STATE)  return (build_module_data());
+  if (req == CLIENT_REQUEST_RELAIS) return (build_relais_data());
+  if (req == CLIENT_REQUEST_TEMP)   return (build_temp_data());
+  if (req == CLIENT_REQUEST_TIME)   return (build_time_data());
+  if (req == CLIENT_REQUEST_LOAD)   return (build_load_data());
+  if (req == CLIENT_REQUEST_LOG)    return (build_log_data());
+  if (req == CLIENT_REQUEST_ADC)    return (build_adc_data());
+
+  return (NULL);
 }
 
 static void ws_event(uint8_t client, WStype_t type, uint8_t *data, size_t len) {
@@ -336,16 +356,19 @@ static void ws_event(uint8_t client, WStype_t type, uint8_t *data, size_t len) {
   }
 }
 
-void websocket_broadcast_message(const String &msg) {
+void websocket_broadcast_message(const String &str) {
   if (!p) return;
 
-  packet_prepare(100, PSTR("BROADCAST"));
+  Message *msg = packet_prepare(100);
 
-  data += F("{\"type\":\"broadcast\",\"value\":\"");
-  data += msg;
-  data += F("\"}");
+  msg->data += F("{\"type\":\"broadcast\",\"value\":\"");
+  msg->data += str;
+  msg->data += F("\"}");
 
-  packet_broadcast();
+  packet_check(msg, 100, PSTR("BROADCAST"));
+  packet_broadcast(msg);
+
+  message_unref(msg);
 }
 
 int websocket_state(void) {
@@ -402,31 +425,36 @@ bool websocket_fini(void) {
 }
 
 void websocket_poll(void) {
+  Message *msg[CLIENT_REQUESTS] = { NULL };
   bool ret;
 
   if (!p) return;
 
   p->websocket->loop();
 
+  // every requested message is serialized only once per poll and
+  // then sent to all clients that asked for it in the meantime
+
   for (int i=0; i<WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-    if (!p) return; // maybe module_call_fini() was called on us
+    if (!p) break; // maybe module_call_fini() was called on us
 
     int &req = p->client_request[i];
 
          if (req == CLIENT_REQUEST_NONE)   continue;
     else if (req == CLIENT_REQUEST_REBOOT) system_reboot();
-    else if (req == CLIENT_REQUEST_STATE)  send_module_data(i);
-    else if (req == CLIENT_REQUEST_RELAIS) send_relais_data(i);
-    else if (req == CLIENT_REQUEST_TEMP)   send_temp_data(i);
-    else if (req == CLIENT_REQUEST_TIME)   send_time_data(i);
-    else if (req == CLIENT_REQUEST_LOAD)   send_load_data(i);
-    else if (req == CLIENT_REQUEST_LOG)    send_log_data(i);
-    else if (req == CLIENT_REQUEST_ADC)    send_adc_data(i);
     else if (req == CLIENT_REQUEST_INIT)   module_call_init(p->module, ret);
     else if (req == CLIENT_REQUEST_FINI)   module_call_fini(p->module, ret);
+    else {
+      if (!msg[req]) msg[req] = build_message(req);
+      if (msg[req])  packet_send(i, msg[req]);
+    }
 
     if (p) req = CLIENT_REQUEST_NONE;
   }
+
+  for (int i=0; i<CLIENT_REQUESTS; i++) {
+    message_unref(msg[i]);
+  }
 }
 
 MODULE(websocket)
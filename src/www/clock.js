@@ -0,0 +1,44 @@
+function format_time(dt) {
+  var hr    = dt.getHours();
+  var min   = dt.getMinutes();
+  var sec   = dt.getSeconds();
+  
+  if (hr  < 10) { hr  = '0' + hr;  }
+  if (min < 10) { min = '0' + min; }
+  if (sec < 10) { sec = '0' + sec; }
+  
+  return (hr + ':' + min + ':' + sec);
+}
+
+function set_browser_time() {
+  var dt = new Date();
+  
+  set_value('browser_date', dt.toDateString());
+  set_value('browser_time', format_time(dt));
+}
+
+function time_timer() {
+  if (polling) {
+    connection.send('time');
+    set_browser_time();
+    setTimeout(time_timer, 233);
+  }
+}
+
+function open_handler() {
+  setTimeout(time_timer, 10);
+}
+
+function message_handler(d) {
+  if (d.type == 'time') {
+    var dt = new Date();
+    
+    dt.setTime(d.localtime + dt.getTimezoneOffset() * 60000);
+    set_value('remote_date', dt.toDateString());
+    set_value('remote_time', format_time(dt));
+  }
+}
+
+function clock_browser_sync() {
+  if (connection) connection.send('sync ' + Date.now());
+}
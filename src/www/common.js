@@ -0,0 +1,117 @@
+function websocket_handle_broadcast(d) {
+  if (d.value == 'logout') {
+    document.location.href = '/login?LOGOUT=YES';
+    polling = false;
+    return;
+  }
+  
+  if (d.value == 'reboot') {
+    spinner_show('Rebooting ...');
+    setTimeout(function() {
+      document.location.href = '/';
+    }, 35000);
+    polling = false;
+    return;
+  }
+  
+  if (d.value == 'update') {
+    if (typeof cleanup_handler == 'function') {
+      cleanup_handler();
+    }
+    spinner_show('Updating ...');
+    polling = false;
+    return;
+  }
+}
+
+if (connection) {
+  connection.onclose = function() {
+    console.log('WebSocket: ', 'Remote side closed connection');
+    polling = false;
+  }
+  
+  connection.onerror = function(error) {
+    console.log('WebSocket: ', error);
+    polling = false;
+  }
+  
+  connection.onopen = function() {
+    if (typeof open_handler == 'function') {
+      open_handler();
+    }
+  }
+  
+  connection.onmessage = function(e) {
+    var d = JSON.parse(e.data);
+    
+    if (d.type == 'broadcast') {
+      websocket_handle_broadcast(d);
+      return;
+    }
+    
+    if (typeof message_handler == 'function') {
+      message_handler(d);
+    }
+  }
+}
+
+function get_element(name) {
+  var elem = document.getElementsByName(name)[0];
+  if (elem) return (elem);
+  return (document.getElementById(name));
+}
+
+function set_type(element, type) {
+  var elem = get_element(element);
+  if (elem) return (elem.attributes['type'] = type);
+}
+
+function set_value(element, value) {
+  var elem = get_element(element);
+  if (elem) {
+    if (elem.nodeName == 'LABEL') {
+      return (elem.innerHTML = value);
+    } else if (elem.nodeName == 'SPAN') {
+      return (elem.textContent = value);
+    } else {
+      return (elem.value = value);
+    }
+  }
+}
+
+function set_readonly(element, readonly) {
+  var elem = (get_element(element));
+  if (elem) return (elem.readOnly = readonly);
+}
+
+function set_disabled(element, disabled) {
+  var elem = (get_element(element));
+  if (elem) return (elem.disabled = disabled);
+}
+
+function set_visible(element, visible) {
+  var elem = (get_element(element));
+  if (elem) {
+    if (!visible) {
+      return (elem.style.display = 'none');
+    } else {
+      return (elem.style.display = 'initial');
+    }
+  }
+}
+
+function set_color(element, color) {
+  var elem = (get_element(element));
+  if (elem) return (elem.style.color = color);
+}
+
+function spinner_show(text) {
+  if (text != null) {
+    document.body.innerHTML = '      <center><h1 class="caption">' + text + '</h1></center>      <div id="spinner" class="spin"></div>    ';
+  }
+  get_element('spinner').style.visibility = 'visible';
+}
+
+function spinner_hide() {
+  get_element('spinner').style.visibility = 'hidden';
+}
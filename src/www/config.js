@@ -0,0 +1,289 @@
+function wifi_scan_network() {
+  spinner_show();
+  
+  request = new XMLHttpRequest();
+  request.open('GET', '/scan', true);
+  request.onreadystatechange = function(e) {
+    if ((request.readyState == 4) && (request.status == 200)) {
+      wifi = eval('(' + request.responseText + ')');
+      wifi_select_fill();
+    }
+    spinner_hide();
+  }
+  
+  request.send();
+}
+
+function wifi_disable_elements() {
+  var select = get_element('wifi_ssid_sel');
+  if (select == null) return;
+  var idx = select.selectedIndex;
+  
+  if (idx == select.options.length - 1) { 
+    set_readonly('wifi_ssid', false);
+    set_disabled('wifi_pass', false);
+  } else {
+    set_readonly('wifi_ssid', true);
+    set_disabled('wifi_pass', wifi[idx]['crypt']==7);
+  }
+  set_disabled('wifi_scan', false);
+}
+
+function wifi_select_changed() {
+  var select = get_element('wifi_ssid_sel');
+  if (select == null) return;
+  var idx = select.selectedIndex;
+  var value = ssid_in_conf;
+  
+  if (idx != select.options.length - 1) {
+    value = wifi[idx]['ssid'];
+  }
+  set_value('wifi_ssid', value);
+  wifi_disable_elements();
+}
+
+function wifi_select_fill() {
+  var select = get_element('wifi_ssid_sel');
+  if (select == null) return;
+  var found = false;
+  
+  select.options.length = 0;
+  for (var i=0; i<wifi.length; i++) {
+    var key = wifi[i]['ssid'];
+    var str = key;
+    str += ' (' + wifi[i]['rssi'] + '%) ';
+    str += (wifi[i]['crypt'] != 7) ? '*' : '';
+    select.options[select.options.length] = new Option(str, key);
+  }
+  select.options[select.options.length] = new Option('<hidden>', '-');
+  
+  for (var i=0; i<wifi.length; i++) {
+    if (wifi[i]['ssid'] == ssid_in_conf) {
+      select.value = ssid_in_conf;
+      wifi_select_changed();
+      found = true;
+      break;
+    }
+  }
+  if (!found) select.value = '-';
+}
+
+function storage_calculate_capacity() {
+  var elem = get_element('storage_space');
+  var free_space = parseInt(elem.value);
+  var mask = get_element('storage_mask');
+  var val = parseInt(mask.value);
+  var bytes = 0;
+  
+  for (var bit=0; bit<2; bit++) {
+    if (val & (1<<bit)) bytes += 1.5; // compressed, a typical delta
+  }
+  bytes += 0.5; // timestamp, usually the same interval again
+  
+  elem = get_element('storage_interval');
+  var interval = parseInt(elem.value);
+
+  // 20 bytes block header, a block spans 1 hour at most
+  bytes += 20 / Math.max(1, Math.min(100, 60 / interval));
+  var bytes_per_hour = bytes * (60 / interval);
+  var total_hours = free_space / bytes_per_hour;
+  var days = Math.floor(total_hours / 24);
+  var hours = Math.round(total_hours - (days * 24));
+  var capacity = '  ';
+  
+  if (days  >= 1) capacity += days + ' day';
+  if (days  >= 2) capacity += 's';
+  if ((days >= 1) && (hours >= 1)) capacity += ', ';
+  if (hours >= 1) capacity += hours + ' hour';
+  if (hours >= 2) capacity += 's';
+  
+  set_value('storage_capacity', capacity);
+}
+
+function storage_select_changed() {
+  var select = get_element('storage_interval_sel');
+  if (select == null) return;
+  
+  set_value('storage_interval', select.value);
+  storage_calculate_capacity();
+}
+
+function storage_select_fill() {
+  var select = get_element('storage_interval_sel');
+  if (select == null) return;
+  var input = get_element('storage_interval');
+  
+  select.options.length = 0;
+  for (var i=0; i<=60; i++) {
+    if (60%i == 0) {
+      select.options[select.options.length] = new Option(i, i);
+    }
+  }
+  
+  select.value = input.value;
+}
+
+function storage_values_check() {
+  var input = get_element('storage_mask');
+  if (input == null) return;
+  var mask = parseInt(input.value);
+  
+  for (var i=0; i<2; i++) {
+    var elem = get_element('storage_mask_' + i);
+    
+    elem.checked = (mask & (1<<i));
+  }
+}
+
+function logger_enable_server() {
+  var mask = get_element('logger_channels');
+  var val = parseInt(mask.value) & (1<<1);
+  
+  set_disabled('logger_host', !val);
+  set_disabled('logger_port', !val);
+}
+
+function logger_channels_check() {
+  var input = get_element('logger_channels');
+  if (input == null) return;
+  var mask = parseInt(input.value);
+  
+  for (var i=0; i<3; i++) {
+    var elem = get_element('logger_channel_' + i);
+    
+    elem.checked = (mask & (1<<i));
+  }
+}
+
+function wifi_elements() {
+  return new Array(
+    get_element('wifi_ssid_sel'),
+    get_element('wifi_ssid'),
+    get_element('wifi_pass'),
+    get_element('wifi_scan'),
+    get_element('wifi_power'),
+    get_element('wifi_watchdog')
+  );
+}
+function ip_elements() {
+  return new Array(
+    get_element('ip_addr'),
+    get_element('ip_netmask'),
+    get_element('ip_gateway'),
+    get_element('ip_dns1'),
+    get_element('ip_dns2')
+  );
+}
+function ap_elements() {
+  return new Array(
+    get_element('ap_addr')
+  );
+}
+function ntp_elements() {
+  return new Array(
+    get_element('ntp_server'),
+    get_element('ntp_interval')
+  );
+}
+function telemetry_elements() {
+  return new Array(
+    get_element('telemetry_url'),
+    get_element('telemetry_user'),
+    get_element('telemetry_pass'),
+    get_element('telemetry_interval')
+  );
+}
+function update_elements() {
+  return new Array(
+    get_element('update_url'),
+    get_element('update_interval')
+  );
+}
+function storage_elements() {
+  var ret = new Array(get_element('storage_interval_sel'));
+  for (var i=0; i<2; i++) {
+    ret.push(get_element('storage_mask_' + i));
+  }
+  ret.push(get_element('storage_capacity'));
+  return (ret);
+}
+function logger_elements() {
+  var ret = new Array(get_element('logger_host'));
+  for (var i=0; i<3; i++) {
+    ret.push(get_element('logger_channel_' + i));
+  }
+  ret.push(get_element('logger_port'));
+  return (ret);
+}
+function set_elements_inactive(elements, disabled) {
+  elements.forEach(function(elem) {
+    elem.disabled = disabled;
+  });
+}
+document.onclick = function(e) {
+  var elem = e ? e.target : window.event.srcElement;
+  var disabled = (elem.value === '0') ? true : false;
+  var ev = [];
+  
+  if (elem.name === 'wifi_enabled') {
+    set_elements_inactive(wifi_elements(), disabled);
+    if (!disabled) wifi_disable_elements();
+    return;
+  }
+  if (elem.name ===         'ip_static') ev =        ip_elements();
+  if (elem.name ===        'ap_enabled') ev =        ap_elements();
+  if (elem.name ===       'ntp_enabled') ev =       ntp_elements();
+  if (elem.name === 'telemetry_enabled') ev = telemetry_elements();
+  if (elem.name ===    'update_enabled') ev =    update_elements();
+  if (elem.name ===   'storage_enabled') ev =   storage_elements();
+  if (elem.name ===    'logger_enabled') ev =    logger_elements();
+  
+  set_elements_inactive(ev, disabled);
+  
+  if (elem.id.substring(0, 13) == 'storage_mask_') {
+    var mask = get_element('storage_mask');
+    var bit = parseInt(elem.id.substring(13));
+    var val = parseInt(mask.value);
+    if (elem.checked) { val |= (1<<bit); } else { val &= ~(1<<bit); }
+    mask.value = val;
+    storage_calculate_capacity();
+  }
+  
+  if (elem.id.substring(0, 15) == 'logger_channel_') {
+    var mask = get_element('logger_channels');
+    var bit = parseInt(elem.id.substring(15));
+    var val = parseInt(mask.value);
+    if (elem.checked) { val |= (1<<bit); } else { val &= ~(1<<bit); }
+    mask.value = val;
+    logger_enable_server();
+  }
+  
+  if (!disabled && (elem.name === 'logger_enabled')) {
+    logger_enable_server();
+  }
+}
+
+function set_inactive(element, elements) {
+  var e = get_element(element);
+  if (e && e.checked) {
+    set_elements_inactive(elements, true);
+  }
+}
+
+window.onload = function(e) {
+  set_inactive(     'wifi_enabled',      wifi_elements());
+  set_inactive(       'ip_static',         ip_elements());
+  set_inactive(       'ap_enabled',        ap_elements());
+  set_inactive(      'ntp_enabled',       ntp_elements());
+  set_inactive('telemetry_enabled', telemetry_elements());
+  set_inactive(   'update_enabled',    update_elements());
+  set_inactive(  'storage_enabled',   storage_elements());
+  set_inactive(   'logger_enabled',    logger_elements());
+  
+  wifi_select_fill();
+  storage_select_fill();
+  storage_values_check();
+  storage_calculate_capacity();
+  logger_channels_check();
+  logger_enable_server();
+}
@@ -0,0 +1,47 @@
+var canvas = get_element('logo');
+var logo   = canvas.getContext('2d');
+var width  = logo.canvas.width;
+var height = logo.canvas.height;
+var origin = { x:width/2, y:height/2 };
+var color  = [ 'rgb(192, 16, 16)', 'rgb(16, 16, 192)' ];
+var gain   = [ height * 0.4, height * 0.3 ];
+var freq   = 0.04;
+var timer  = 0;
+var phase  = 0;
+
+function cleanup_handler() {
+  clearInterval(timer);
+}
+
+function logo_paint() {
+  logo.clearRect(0, 0, width, height);
+  logo.beginPath();
+  logo.strokeStyle = 'rgb(32, 192, 32)';
+  logo.moveTo(0, origin.y); logo.lineTo(width, origin.y);  // X axis
+  logo.moveTo(origin.x, 0); logo.lineTo(origin.x, height); // Y axis
+  logo.stroke();
+  
+  for (var w=0; w<2; w++) {
+    var shift = (w==0) ? 15 : -15;
+    
+    logo.beginPath();
+    logo.lineWidth = 5;
+    logo.strokeStyle = color[w];
+    
+    var s = Math.sin(freq * (-width/2 + shift + phase));
+    var x = -width/2 + origin.x;
+    var y = s * gain[w] + origin.y;
+    logo.moveTo(x, y);
+    for (var i=-width/2; i<width/2; i++) {
+      x = i + origin.x;
+      y = Math.sin(freq*(i + shift + phase))*gain[w] + origin.y;
+      
+      logo.lineTo(x, y);
+    }
+    logo.stroke();
+  }
+  
+  if (phase > width/2+4) phase = 0; else phase += 2;
+}
+
+timer = setInterval(logo_paint, 50);
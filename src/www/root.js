@@ -0,0 +1,27 @@
+function adc_timer() {
+  if (polling) {
+    connection.send('adc');
+    setTimeout(adc_timer, 1000);
+  }
+}
+
+function temp_timer() {
+  if (polling) {
+    connection.send('temp');
+    setTimeout(temp_timer, 2003);
+  }
+}
+
+function open_handler() {
+  setTimeout(adc_timer,  100);
+  setTimeout(temp_timer, 200);
+}
+
+function message_handler(d) {
+  if (d.type == 'adc') {
+    set_value('adc', d.value + '  ');
+  }
+  if (d.type == 'temp') {
+    set_value('temp', d.value + '  ');
+  }
+}
@@ -0,0 +1,115 @@
+function load_timer() {
+  if (polling) {
+    connection.send('load');
+    setTimeout(load_timer, 1009);
+  }
+}
+function state_timer() {
+  if (polling) {
+    connection.send('state');
+    setTimeout(state_timer, 777);
+  }
+}
+function time_timer() {
+  if (polling) {
+    connection.send('time');
+    setTimeout(time_timer, 293);
+  }
+}
+
+function open_handler() {
+  setTimeout( load_timer, 10);
+  setTimeout( time_timer, 20);
+  setTimeout(state_timer, 30);
+}
+
+function message_handler(d) {
+  if (d.type == 'load') {
+    sys_draw_load(d);
+  }
+  if (d.type == 'module') {
+    sys_update_modules(d);
+  }
+  if (d.type == 'time') {
+    set_value('uptime', d.uptime);
+    set_value('utc',    d.utc);
+  }
+}
+
+function sys_update_modules(data) {
+  var state = data.state;
+  for (i=0; i<state.length; i++) {
+    var col = (state[i]=='ACTIVE')?'#1b1':'#b11';
+    set_value('module_' + i + '_state', state[i]);
+    set_color('module_' + i + '_state', col);
+  }
+}
+
+function sys_draw_load(data) {
+  var canvas = get_element('canvas_load')
+  var ctx = canvas.getContext('2d');
+  
+  drawLoadAxes(ctx);
+  drawLoadGraph(ctx, 'cpu', data);
+  drawLoadGraph(ctx, 'mem', data);
+  drawLoadGraph(ctx, 'net', data);
+  
+  var cpu = data.cpu.values[data.cpu.values.length-1];
+  var mem = data.mem.values[data.mem.values.length-1];
+  var net = data.net.values[data.net.values.length-1];
+  
+  set_value('load_cpu_perc', cpu + '%');
+  set_value('load_mem_perc', mem + '%');
+  set_value('load_net_perc', net + '%');
+  
+  set_value('load_cpu_loops', '(' + data.cpu.loops + ' loops/s)');
+  set_value('load_mem_free',  '(' + data.mem.free  + ' bytes free)');
+  set_value('load_net_xfer',  '(' + data.net.xfer  + ' bytes/s)');
+}
+
+function drawLoadGraph(ctx, name, data) {
+  if (name == 'cpu') {
+    var color = 'rgb(192, 16, 16)'; // red
+    var val = data.cpu.values;
+  } else if (name == 'mem') {
+    var color = 'rgb(16, 16, 192)'; // blue
+    var val = data.mem.values;
+  } else if (name == 'net') {
+    var color = 'rgb(16, 192, 16)'; // green
+    var val = data.net.values;
+  }
+  
+  var delta  = ctx.canvas.width / (val.length-1);
+  var height = ctx.canvas.height;
+  var scale  = height / 100;
+  
+  ctx.beginPath();
+  ctx.lineWidth = 2;
+  ctx.strokeStyle = color;
+  
+  ctx.moveTo(0, height - (scale * val[0]));
+  for (i=1; i<val.length-1; i++) {
+    var x  = delta * i;
+    var y  = height - (scale * val[i]);
+    var xc = x + delta / 2;
+    var yc = (y + height - (scale * val[i+1])) / 2;
+    ctx.quadraticCurveTo(x, y, xc, yc);
+  }
+  ctx.quadraticCurveTo(delta * i,     height - (scale * val[i]),
+                       delta * (i+1), height - (scale * val[i+1]));
+  ctx.stroke();
+}
+
+function drawLoadAxes(ctx) {
+  var x0 = 0;
+  var y0 = ctx.canvas.height;
+  var w = ctx.canvas.width;
+  var h = ctx.canvas.height;
+  
+  ctx.clearRect(0, 0, ctx.canvas.width, ctx.canvas.height);
+  ctx.beginPath();
+  ctx.strokeStyle = 'rgb(128, 128, 128)';
+  ctx.moveTo(0, y0); ctx.lineTo(w, y0); // X axis
+  ctx.moveTo(x0, 0); ctx.lineTo(x0, h); // Y axis
+  ctx.stroke();
+}